@@ -0,0 +1,169 @@
+
+#ifndef KINGDOMCARD_PACKED_WIRE_H
+#define KINGDOMCARD_PACKED_WIRE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "紧凑编码按小端字节序直接读写结构体"
+#endif
+
+/// @brief 玩家连接上的紧凑二进制编码, 与 basic_message.proto 中的消息一一对应
+/// @details 每帧是一个 Header 加上定长的消息体, 字段按小端、1 字节对齐排列, 收到后校验长度即可原地读取,
+///          不需要像 protobuf 那样先解析外层 BasicMessage 再解析 message 字段.
+///          连接时在 ConnectRequest 中申请, 登入端口上的 CONNECT_REQ/CONNECT_REP 始终使用 protobuf
+namespace wire {
+    enum Format : uint32_t {
+        PROTOBUF = 0,
+        PACKED = 1
+    };
+
+    uint8_t const VERSION = 2;              // 布局有任何变化都须加一
+    uint32_t const NO_PLAYER = 0xffffffff;  // 没有目标玩家, 即 protobuf 中的 (uint32) -1
+    uint8_t const BATCH_MAGIC = 0xb7;       // 线型为 7, 不是合法的 protobuf 开头, 也不等于 VERSION
+    uint8_t const BATCH_ZSTD = 1;           // Batch::flags: 消息区整体以 zstd 压缩
+
+#pragma pack(push, 1)
+    struct Header {
+        uint8_t version;
+        uint8_t type;                       // CommandType
+        uint32_t playerId;
+    };
+
+    struct Card {
+        uint16_t id;
+        uint8_t type;                       // CardType_pb
+    };
+
+    struct PlayerState {
+        uint32_t id;
+        uint8_t hp;
+        uint8_t maxHp;
+        uint8_t cardCount;
+        uint8_t alive;
+    };
+
+    struct GameStart {
+        uint8_t identity;                   // PlayerIdentity_pb
+        uint32_t lordId;
+    };
+
+    /// @brief 之后紧跟 totalPlayers 个 PlayerState
+    struct GameStatus {
+        uint8_t totalPlayers;
+        uint32_t currentTurnPlayerId;
+    };
+
+    struct NoticeCard {
+        uint32_t playerId;
+        Card card;
+        uint32_t targetPlayerId;
+    };
+
+    /// @brief NOTICE_DYING 与 NOTICE_DEAD
+    struct NoticePlayer {
+        uint32_t playerId;
+    };
+
+    struct GameOver {
+        uint8_t victoryCamp;                // PlayerIdentity_pb
+    };
+
+    struct YourTurn {
+        int64_t deadline;
+        float remainingTime;
+        uint8_t turnType;                   // TurnType_pb
+    };
+
+    /// @brief NEW_CARD、DISCARD_CARD 与 ACTION_PASS, 之后紧跟 count 个 Card
+    struct CardList {
+        uint8_t count;
+    };
+
+    struct ActionPlay {
+        Card card;
+        uint32_t targetPlayerId;
+    };
+
+    struct ActionReject {
+        Card card;
+        uint8_t reason;                     // RejectReason_pb
+    };
+
+    struct ClockSync {
+        uint64_t serverTime;
+        uint64_t clientTime;
+        uint32_t remainingRounds;
+    };
+
+    /// @brief 合并帧, 连接时以 batch_frames 协商, 两种编码都可以使用
+    /// @details 之后是消息区: count 条 {uint32 长度, 原样的单条消息帧}; 压缩时 rawSize 为解压后消息区的长度
+    struct Batch {
+        uint8_t magic;
+        uint8_t flags;
+        uint16_t count;
+        uint32_t rawSize;
+    };
+#pragma pack(pop)
+
+    /// @brief 原地读取 data 中 offset 处的结构体, 长度不够时为 nullptr
+    template<typename T>
+    const T *view(const void *data, size_t size, size_t offset = 0) {
+        return offset + sizeof(T) <= size ? reinterpret_cast<const T *>(static_cast<const char *>(data) + offset)
+                                          : nullptr;
+    }
+
+    /// @brief 原地读取紧跟在 offset 处的 count 个结构体
+    template<typename T>
+    const T *viewArray(const void *data, size_t size, size_t offset, size_t count) {
+        return offset + sizeof(T) * count <= size
+               ? reinterpret_cast<const T *>(static_cast<const char *>(data) + offset) : nullptr;
+    }
+
+    /// @brief 读取并校验帧头, 版本不符或长度不够时为 nullptr
+    inline const Header *header(const void *data, size_t size) {
+        const Header *h = view<Header>(data, size);
+        return h != nullptr && h->version == VERSION ? h : nullptr;
+    }
+
+    template<typename T>
+    void append(std::string &out, const T &value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    /// @brief 在 out 中写入帧头, 消息体随后用 append 写入
+    inline void appendHeader(std::string &out, uint8_t type, uint32_t player_id) {
+        append(out, Header{VERSION, type, player_id});
+    }
+
+    /// @brief 判断一帧是否为合并帧, 是则返回帧头
+    inline const Batch *batch(const void *data, size_t size) {
+        const Batch *b = view<Batch>(data, size);
+        return b != nullptr && b->magic == BATCH_MAGIC ? b : nullptr;
+    }
+
+    /// @brief 依次取出 (已解压的) 消息区中的各条消息, 交给 f(const char *frame, size_t size)
+    /// @return 长度前缀与消息区吻合
+    template<typename F>
+    bool forEachInBatch(const char *body, size_t size, F &&f) {
+        size_t offset = 0;
+        while (offset < size) {
+            uint32_t length;
+            if (offset + sizeof(length) > size)
+                return false;
+            std::memcpy(&length, body + offset, sizeof(length));
+            offset += sizeof(length);
+            if (length > size - offset)
+                return false;
+            f(body + offset, static_cast<size_t>(length));
+            offset += length;
+        }
+        return true;
+    }
+
+}
+
+#endif //KINGDOMCARD_PACKED_WIRE_H
@@ -0,0 +1,43 @@
+#include "AllocCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+    thread_local uint64_t allocCount = 0;
+
+    void *allocate(std::size_t size) {
+        ++allocCount;
+        if (void *ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+}
+
+namespace bench {
+    uint64_t allocations() {
+        return allocCount;
+    }
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+
+void *operator new[](std::size_t size) { return allocate(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    ++allocCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    ++allocCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,14 @@
+
+#ifndef KINGDOMCARD_ALLOCCOUNTER_H
+#define KINGDOMCARD_ALLOCCOUNTER_H
+
+#include <cstdint>
+
+namespace bench {
+    /// @brief 当前线程累计的堆分配次数
+    /// @details kc_bench 替换了全局 operator new, 只统计调用线程,
+    ///          不受 Table 中客户端线程的干扰
+    uint64_t allocations();
+}
+
+#endif //KINGDOMCARD_ALLOCCOUNTER_H
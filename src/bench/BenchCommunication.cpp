@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <zmq.hpp>
+#include "BenchTable.h"
+#include "basic/Player.h"
+#include "basic/Utility.h"
+
+namespace {
+    /// @brief 一个 Player 与其对端, 第一个参数 0 为 inproc, 1 为 tcp, 2 为 ipc
+    struct Link {
+        kc::Player player;
+        zmq::socket_t peer;
+
+        explicit Link(int64_t transport)
+                : player(0, zmq::socket_t(bench::context(), ZMQ_PAIR)), peer(bench::context(), ZMQ_PAIR) {
+            static size_t linkCounter = 0;
+            std::string suffix = std::to_string(linkCounter++);
+            player.socket.bind(transport == 0 ? "inproc://bench-link-" + suffix
+                               : transport == 1 ? std::string("tcp://127.0.0.1:*")
+                               : "ipc:///tmp/kc-bench-link-" + suffix + ".ipc");
+            peer.connect(player.socket.get(zmq::sockopt::last_endpoint));
+        }
+
+        ~Link() {
+            peer.close();
+            player.socket.close();
+        }
+    };
+
+    const char *transportName(int64_t transport) {
+        return transport == 0 ? "inproc" : transport == 1 ? "tcp" : "ipc";
+    }
+}
+
+static void BM_SendCommand(benchmark::State &state) {
+    Link link(state.range(0));
+    std::string payload(state.range(1), 'x');
+    zmq::message_t msg;
+    for (auto _ : state) {
+        util::sendCommand(link.player, CommandType::GAME_STATUS, payload);
+        link.peer.recv(msg, zmq::recv_flags::none);
+    }
+    state.SetLabel(transportName(state.range(0)));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_SendCommand)->ArgsProduct({{0, 1, 2}, {16, 256}});
+
+static void BM_RecvCommand(benchmark::State &state) {
+    Link link(state.range(0));
+    BasicMessage m;
+    m.set_type(CommandType::ACTION_PLAY);
+    m.set_player_id(0);
+    m.set_message(std::string(state.range(1), 'x'));
+    std::string wire = m.SerializeAsString();
+    std::string payload;
+    for (auto _ : state) {
+        link.peer.send(zmq::message_t(wire.data(), wire.size()), zmq::send_flags::none);
+        benchmark::DoNotOptimize(util::recvCommand(link.player, payload));
+    }
+    state.SetLabel(transportName(state.range(0)));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_RecvCommand)->ArgsProduct({{0, 1, 2}, {16, 256}});
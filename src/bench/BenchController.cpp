@@ -0,0 +1,147 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include "AllocCounter.h"
+#include "BenchTable.h"
+#include "basic/BotPlayer.h"
+#include "basic/GameController.h"
+
+namespace kc {
+    /// @brief 访问 GameController 私有成员的探针
+    class GameControllerProbe {
+    public:
+        static void init(GameController &controller) { controller.init(); }
+
+        static void bcStatus(GameController &controller) { controller.bcStatus(); }
+
+        static CardPtr drawCard(GameController &controller) { return controller.drawCard(); }
+
+        static std::vector<CardPtr> &cards(GameController &controller) { return controller.cards; }
+
+        static std::optional<CardAction> react(GameController &controller, TurnType type) {
+            return controller.waitForReact(controller.getPlayerList(), type);
+        }
+
+        static PlayError validate(GameController &controller, const CardAction &action) {
+            return controller.validatePlay(action);
+        }
+
+        static const PlayerTable &table(GameController &controller) { return controller.table; }
+
+        static MatchSnapshot snapshot(GameController &controller) { return controller.snapshot(); }
+
+        static void turn(GameController &controller) {
+            controller.newTurn();
+            controller.nextPlayerIdx();
+        }
+    };
+}
+
+using kc::GameControllerProbe;
+
+namespace {
+    /// @brief 以每次迭代的平均堆分配次数报告
+    void reportAllocations(benchmark::State &state, uint64_t start) {
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(bench::allocations() - start),
+                                                      benchmark::Counter::kAvgIterations);
+    }
+
+    /// @brief 报告堆分配次数, 计时区内有任何分配时使本项失败
+    void expectNoAllocations(benchmark::State &state, uint64_t start) {
+        uint64_t count = bench::allocations() - start;
+        reportAllocations(state, start);
+        if (count != 0)
+            state.SkipWithError(("计时区内发生了 " + std::to_string(count) + " 次堆分配").c_str());
+    }
+}
+
+static void BM_BcStatus(benchmark::State &state) {
+    bench::Table table(state.range(0));
+    kc::GameController controller(table.players);
+    for (auto _ : state)
+        GameControllerProbe::bcStatus(controller);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_BcStatus)->Arg(4)->Arg(10);
+
+static void BM_DrawCard(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players;
+    kc::GameController controller(players);
+    auto &deck = GameControllerProbe::cards(controller);
+    deck = kc::Card::generateDeck();
+    for (auto _ : state) {
+        kc::CardPtr card = GameControllerProbe::drawCard(controller);
+        deck.emplace_back(std::move(card));
+    }
+    state.counters["deck"] = static_cast<double>(deck.size());
+}
+BENCHMARK(BM_DrawCard);
+
+static void BM_SimulatedTurn(benchmark::State &state) {
+    bench::Table table(state.range(0));
+    kc::GameController controller(table.players);
+    GameControllerProbe::init(controller);
+    uint64_t start = bench::allocations();
+    for (auto _ : state)
+        GameControllerProbe::turn(controller);
+    reportAllocations(state, start);
+}
+BENCHMARK(BM_SimulatedTurn)->Arg(4)->Arg(10)->UseRealTime();
+
+static void BM_WaitForReact(benchmark::State &state) {
+    bench::Table table(state.range(0));
+    kc::GameController controller(table.players);
+    GameControllerProbe::init(controller);
+    uint64_t start = bench::allocations();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(GameControllerProbe::react(controller, kc::TurnType::PASSIVE));
+    reportAllocations(state, start);
+}
+BENCHMARK(BM_WaitForReact)->Arg(4)->Arg(10)->UseRealTime();
+
+/// 只有机器人时反应窗口不经过网络, 记账部分应当没有任何堆分配, 有分配时本项失败
+static void BM_WaitForReactBots(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players;
+    for (int64_t i = 0; i < state.range(0); ++i)
+        players.emplace_back(std::make_shared<kc::BotPlayer>(i));
+    kc::GameController controller(players);
+    GameControllerProbe::init(controller);
+    uint64_t start = bench::allocations();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(GameControllerProbe::react(controller, kc::TurnType::PASSIVE));
+    expectNoAllocations(state, start);
+}
+BENCHMARK(BM_WaitForReactBots)->Arg(4)->Arg(10);
+
+/// 出牌校验在广播之前进行, 归属、牌型与目标的检查都应是常数时间
+static void BM_ValidatePlay(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players;
+    for (int64_t i = 0; i < state.range(0); ++i)
+        players.emplace_back(std::make_shared<kc::BotPlayer>(i));
+    kc::GameController controller(players);
+    GameControllerProbe::init(controller);
+    const kc::PlayerTable &table = GameControllerProbe::table(controller);
+    const kc::Card &card = *players[0]->getCards().front();
+    kc::CardAction owned{card.id, card.type, table.id[0], table.id[1]};
+    kc::CardAction stolen{card.id, card.type, table.id[1], table.id[0]};
+    bool flip = false;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GameControllerProbe::validate(controller, flip ? stolen : owned));
+        flip = !flip;
+    }
+}
+BENCHMARK(BM_ValidatePlay)->Arg(4)->Arg(10);
+
+/// 每个回合边界都要生成一次快照, 应在微秒以内且没有堆分配, 有分配时本项失败
+static void BM_Snapshot(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players;
+    for (int64_t i = 0; i < state.range(0); ++i)
+        players.emplace_back(std::make_shared<kc::BotPlayer>(i));
+    kc::GameController controller(players);
+    GameControllerProbe::init(controller);
+    uint64_t start = bench::allocations();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(GameControllerProbe::snapshot(controller));
+    expectNoAllocations(state, start);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sizeof(kc::MatchSnapshot)));
+}
+BENCHMARK(BM_Snapshot)->Arg(4)->Arg(10);
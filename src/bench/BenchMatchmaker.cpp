@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "basic/Matchmaker.h"
+
+namespace {
+    std::vector<kc::PlayerPtr> makePlayers(size_t num) {
+        std::vector<kc::PlayerPtr> players;
+        players.reserve(num);
+        for (size_t i = 0; i < num; ++i)
+            players.emplace_back(std::make_shared<kc::Player>(i, zmq::socket_t()));
+        return players;
+    }
+
+    /// @brief 按正态分布的分数与最近 30s 内均匀分布的入队时间填满队列
+    void fill(kc::Matchmaker &matchmaker, const std::vector<kc::PlayerPtr> &players, std::mt19937 &rng) {
+        std::normal_distribution<double> rating(kc::DEFAULT_RATING, 300);
+        auto now = std::chrono::steady_clock::now();
+        for (const auto &player : players)
+            matchmaker.enqueue(player, static_cast<uint32_t>(std::max(0.0, rating(rng))),
+                               now - std::chrono::milliseconds(rng() % 30000));
+    }
+}
+
+static void BM_MatchmakerEnqueue(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players = makePlayers(state.range(0) + 1);
+    std::mt19937 rng(42);
+    kc::Matchmaker matchmaker;
+    fill(matchmaker, {players.begin(), players.end() - 1}, rng);
+    uint32_t rating = 0;
+    for (auto _ : state) {
+        rating = (rating + 37) % 3000;
+        matchmaker.enqueue(players.back(), rating);
+    }
+    benchmark::DoNotOptimize(matchmaker.size());
+}
+BENCHMARK(BM_MatchmakerEnqueue)->Arg(1000)->Arg(10000)->Arg(50000);
+
+static void BM_MatchmakerTick(benchmark::State &state) {
+    std::vector<kc::PlayerPtr> players = makePlayers(state.range(0));
+    std::mt19937 rng(42);
+    kc::Matchmaker matchmaker;
+    size_t seated = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        matchmaker.clear();
+        fill(matchmaker, players, rng);
+        state.ResumeTiming();
+        for (const auto &table : matchmaker.tick())
+            seated += table.size();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["seated"] = benchmark::Counter(static_cast<double>(seated), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MatchmakerTick)->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <zmq.hpp>
+#include "basic/Card.h"
+#include "basic/Player.h"
+#include "basic/PlayerTable.h"
+#include "basic/Utility.h"
+
+namespace {
+    /// @brief 构造一个持有 n 张手牌且没有无懈可击的玩家
+    void fillHand(kc::Player &player, int64_t n) {
+        for (int64_t i = 0; i < n; ++i)
+            player.addCard(kc::Card::generate(static_cast<kc::CardType>(i % (kc::CARD_TYPE_COUNT - 1))));
+    }
+
+    /// @brief 构造一张 MAX_PLAYER_NUM 人的座位表, 座位 0 持有 n 张手牌且没有无懈可击
+    kc::PlayerTable makeTable(int64_t n) {
+        std::vector<kc::PlayerPtr> players;
+        for (size_t i = 0; i < kc::MAX_PLAYER_NUM; ++i)
+            players.emplace_back(std::make_shared<kc::Player>(i * 7 + 1, zmq::socket_t()));
+        kc::PlayerTable table;
+        table.reset(players);
+        for (int64_t i = 0; i < n; ++i) {
+            kc::CardPtr card = kc::Card::generate(static_cast<kc::CardType>(i % (kc::CARD_TYPE_COUNT - 1)));
+            table.addCard(0, *card);
+        }
+        return table;
+    }
+}
+
+static void BM_TableHasCard(benchmark::State &state) {
+    kc::PlayerTable table = makeTable(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(table.hasCard(0, kc::CardType::UNRELENTING));
+}
+BENCHMARK(BM_TableHasCard)->RangeMultiplier(2)->Range(4, 32);
+
+static void BM_TableHasCardSet(benchmark::State &state) {
+    kc::PlayerTable table = makeTable(state.range(0));
+    uint32_t mask = kc::cardMask(kc::TurnType::PASSIVE);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(table.hasCard(0, mask));
+}
+BENCHMARK(BM_TableHasCardSet)->RangeMultiplier(2)->Range(4, 32);
+
+static void BM_TableSeatOf(benchmark::State &state) {
+    kc::PlayerTable table = makeTable(0);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.seatOf((i % kc::MAX_PLAYER_NUM) * 7 + 1));
+        ++i;
+    }
+}
+BENCHMARK(BM_TableSeatOf);
+
+static void BM_TableNextAliveSeat(benchmark::State &state) {
+    kc::PlayerTable table = makeTable(0);
+    // 隔一个座位死亡, 覆盖跳过死亡座位的情形
+    for (size_t seat = 1; seat < table.size; seat += 2)
+        table.kill(seat);
+    size_t seat = 0;
+    for (auto _ : state) {
+        seat = table.nextAliveSeat(seat);
+        benchmark::DoNotOptimize(seat);
+    }
+}
+BENCHMARK(BM_TableNextAliveSeat);
+
+static void BM_PlayerRemoveCard(benchmark::State &state) {
+    kc::Player player(0, zmq::socket_t());
+    fillHand(player, state.range(0));
+    for (auto _ : state) {
+        // 每次移除最早的一张牌再放回末尾, 覆盖 vector 整体搬移的代价
+        size_t cid = player.getCards().front()->id;
+        kc::CardPtr card = player.removeCard(cid);
+        player.addCard(std::move(card));
+    }
+}
+BENCHMARK(BM_PlayerRemoveCard)->RangeMultiplier(2)->Range(4, 32);
+
+static void BM_ToPbPlayer(benchmark::State &state) {
+    kc::PlayerTable table = makeTable(4);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(util::to_pb(table, 0));
+}
+BENCHMARK(BM_ToPbPlayer);
+
+static void BM_ToPbCard(benchmark::State &state) {
+    kc::CardPtr card = kc::Card::generate(kc::CardType::SLASH);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(util::to_pb(*card));
+}
+BENCHMARK(BM_ToPbCard);
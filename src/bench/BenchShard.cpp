@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include "basic/SpscQueue.h"
+#include "basic/TimerWheel.h"
+
+/// @brief 同一线程交替放入与取出, 衡量无竞争时一次交接的开销
+static void BM_SpscQueuePushPop(benchmark::State &state) {
+    kc::SpscQueue<uint64_t, 256> queue;
+    uint64_t value = 0;
+    for (auto _ : state) {
+        queue.push(value++);
+        benchmark::DoNotOptimize(queue.pop());
+    }
+}
+BENCHMARK(BM_SpscQueuePushPop);
+
+/// @brief 生产者与消费者各占一个线程, 衡量跨线程 (如大厅向分片投递房间) 的吞吐
+static void BM_SpscQueueCrossThread(benchmark::State &state) {
+    kc::SpscQueue<uint64_t, 256> queue;
+    std::atomic<bool> done{false};
+    uint64_t received = 0;
+    std::thread consumer([&]() {
+        while (!done.load(std::memory_order_relaxed) || !queue.empty())
+            if (queue.pop().has_value())
+                ++received;
+    });
+    uint64_t value = 0;
+    for (auto _ : state) {
+        while (!queue.push(uint64_t(value)))
+            ;
+        ++value;
+    }
+    done = true;
+    consumer.join();
+    state.SetItemsProcessed(static_cast<int64_t>(received));
+}
+BENCHMARK(BM_SpscQueueCrossThread)->UseRealTime();
+
+/// @brief 登记后立即取消, 对应每次等待出牌或响应时都会提前收到消息的常见情形
+static void BM_TimerWheelScheduleCancel(benchmark::State &state) {
+    auto &wheel = kc::TimerWheel::instance();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(wheel.cancel(wheel.schedule(deadline, []() {})));
+}
+BENCHMARK(BM_TimerWheelScheduleCancel);
@@ -0,0 +1,60 @@
+#include "BenchTable.h"
+
+#include "basic_message.pb.h"
+#include "command.pb.h"
+
+namespace bench {
+    zmq::context_t &context() {
+        static zmq::context_t context(1);
+        return context;
+    }
+
+    Table::Table(size_t player_num) {
+        static size_t tableCounter = 0;
+        size_t table_id = tableCounter++;
+        for (size_t i = 0; i < player_num; ++i) {
+            std::string endpoint = "inproc://bench-table-" + std::to_string(table_id) + "-" + std::to_string(i);
+            zmq::socket_t socket(context(), ZMQ_PAIR);
+            socket.bind(endpoint);
+            zmq::socket_t peer(context(), ZMQ_PAIR);
+            peer.connect(endpoint);
+            players.emplace_back(std::make_shared<kc::Player>(i, std::move(socket)));
+            peers.emplace_back(std::move(peer));
+        }
+        clientThread = std::thread(&Table::spin, this);
+    }
+
+    Table::~Table() {
+        isRunning = false;
+        clientThread.join();
+        for (auto &peer : peers)
+            peer.close();
+        for (auto &player : players)
+            player->socket.close();
+    }
+
+    void Table::spin() {
+        std::vector<zmq::pollitem_t> poll_items;
+        for (auto &peer : peers)
+            poll_items.emplace_back(zmq::pollitem_t{peer, 0, ZMQ_POLLIN, 0});
+        BasicMessage pass_m;
+        pass_m.set_type(CommandType::ACTION_PASS);
+        pass_m.set_message(ActionPass().SerializeAsString());
+        std::string pass_s = pass_m.SerializeAsString();
+        while (isRunning) {
+            if (zmq::poll(poll_items, std::chrono::milliseconds(100)) == 0)
+                continue;
+            for (size_t i = 0; i < peers.size(); ++i) {
+                if (!(poll_items[i].revents & ZMQ_POLLIN))
+                    continue;
+                zmq::message_t msg;
+                while (peers[i].recv(msg, zmq::recv_flags::dontwait).has_value()) {
+                    BasicMessage m;
+                    m.ParseFromArray(msg.data(), static_cast<int>(msg.size()));
+                    if (m.type() == CommandType::YOUR_TURN)
+                        peers[i].send(zmq::message_t(pass_s.data(), pass_s.size()), zmq::send_flags::none);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef KINGDOMCARD_BENCHTABLE_H
+#define KINGDOMCARD_BENCHTABLE_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include "basic/Player.h"
+
+namespace bench {
+    zmq::context_t &context();
+
+    /// @brief 一张模拟牌桌: 服务端 Player 与其 inproc 对端一一相连,
+    ///        后台线程扮演所有客户端, 收到 YOUR_TURN 时立即 ACTION_PASS
+    class Table {
+    private:
+        std::vector<zmq::socket_t> peers;
+        std::thread clientThread;
+        std::atomic<bool> isRunning{true};
+
+        void spin();
+
+    public:
+        std::vector<kc::PlayerPtr> players;
+
+        explicit Table(size_t player_num);
+
+        Table(const Table &) = delete;
+
+        ~Table();
+    };
+}
+
+#endif //KINGDOMCARD_BENCHTABLE_H
@@ -0,0 +1,192 @@
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "basic/WireCodec.h"
+#include "basic_message.pb.h"
+#include "command.pb.h"
+
+namespace {
+    /// @brief 一种典型消息, 第一个参数: 0 为 10 人的 GAME_STATUS, 1 为 NOTICE_CARD, 2 为 YOUR_TURN,
+    ///        3 为 4 张牌的 NEW_CARD, 4 为 ACTION_PLAY
+    struct Sample {
+        CommandType type;
+        std::unique_ptr<google::protobuf::Message> message;
+
+        explicit Sample(int64_t kind) {
+            switch (kind) {
+                case 0: {
+                    auto status = std::make_unique<GameStatus>();
+                    status->set_totalplayers(10);
+                    for (uint32_t id = 0; id < 10; ++id) {
+                        Player_pb *player = status->add_players();
+                        player->set_id(id);
+                        player->set_hp(3);
+                        player->set_maxhp(4);
+                        player->set_cardcnt(5);
+                        player->set_isalive(true);
+                    }
+                    status->set_currentturnplayerid(3);
+                    type = CommandType::GAME_STATUS;
+                    message = std::move(status);
+                    break;
+                }
+                case 1: {
+                    auto notice = std::make_unique<NoticeCard>();
+                    notice->set_playerid(3);
+                    notice->mutable_card()->set_id(87);
+                    notice->mutable_card()->set_type(SLASH);
+                    notice->set_targetplayerid(5);
+                    type = CommandType::NOTICE_CARD;
+                    message = std::move(notice);
+                    break;
+                }
+                case 2: {
+                    auto turn = std::make_unique<YourTurn>();
+                    turn->set_remainingtime(14985.5f);
+                    turn->set_turntype(ACTIVE);
+                    turn->set_deadline(1234567890123);
+                    type = CommandType::YOUR_TURN;
+                    message = std::move(turn);
+                    break;
+                }
+                case 3: {
+                    auto cards = std::make_unique<NewCard>();
+                    for (uint32_t id = 100; id < 104; ++id) {
+                        Card_pb *card = cards->add_newcards();
+                        card->set_id(id);
+                        card->set_type(static_cast<CardType_pb>(id % 12));
+                    }
+                    type = CommandType::NEW_CARD;
+                    message = std::move(cards);
+                    break;
+                }
+                default: {
+                    auto play = std::make_unique<ActionPlay>();
+                    play->mutable_card()->set_id(87);
+                    play->mutable_card()->set_type(DUEL);
+                    play->set_targetplayerid(5);
+                    type = CommandType::ACTION_PLAY;
+                    message = std::move(play);
+                    break;
+                }
+            }
+        }
+
+        [[nodiscard]] std::string protobufFrame() const {
+            BasicMessage envelope;
+            envelope.set_type(type);
+            envelope.set_player_id(3);
+            envelope.set_message(message->SerializeAsString());
+            return envelope.SerializeAsString();
+        }
+
+        [[nodiscard]] std::string packedFrame() const {
+            std::string frame;
+            wire::appendHeader(frame, static_cast<uint8_t>(type), 3);
+            util::encodePacked(type, *message, frame);
+            return frame;
+        }
+    };
+
+    const char *kindName(int64_t kind) {
+        static const char *const names[] = {"GAME_STATUS", "NOTICE_CARD", "YOUR_TURN", "NEW_CARD", "ACTION_PLAY"};
+        return names[kind];
+    }
+
+    /// @brief 原地读取紧凑编码的帧, 取出客户端处理时会用到的字段
+    uint64_t readInPlace(const std::string &frame) {
+        const wire::Header *header = wire::header(frame.data(), frame.size());
+        const char *body = frame.data() + sizeof(wire::Header);
+        size_t size = frame.size() - sizeof(wire::Header);
+        switch (header->type) {
+            case CommandType::GAME_STATUS: {
+                const auto *status = wire::view<wire::GameStatus>(body, size);
+                const auto *players = wire::viewArray<wire::PlayerState>(body, size, sizeof(wire::GameStatus),
+                                                                         status->totalPlayers);
+                uint64_t sum = status->currentTurnPlayerId;
+                for (size_t i = 0; i < status->totalPlayers; ++i)
+                    sum += players[i].id + players[i].hp + players[i].cardCount + players[i].alive;
+                return sum;
+            }
+            case CommandType::NOTICE_CARD: {
+                const auto *notice = wire::view<wire::NoticeCard>(body, size);
+                return notice->playerId + notice->card.id + notice->targetPlayerId;
+            }
+            case CommandType::YOUR_TURN: {
+                const auto *turn = wire::view<wire::YourTurn>(body, size);
+                return turn->deadline + turn->turnType;
+            }
+            case CommandType::NEW_CARD: {
+                const auto *list = wire::view<wire::CardList>(body, size);
+                const auto *cards = wire::viewArray<wire::Card>(body, size, sizeof(wire::CardList), list->count);
+                uint64_t sum = 0;
+                for (size_t i = 0; i < list->count; ++i)
+                    sum += cards[i].id + cards[i].type;
+                return sum;
+            }
+            default: {
+                const auto *play = wire::view<wire::ActionPlay>(body, size);
+                return play->card.id + play->targetPlayerId;
+            }
+        }
+    }
+}
+
+static void BM_WireProtobufSerialize(benchmark::State &state) {
+    Sample sample(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sample.protobufFrame());
+    state.SetLabel(kindName(state.range(0)));
+    state.counters["bytes"] = static_cast<double>(sample.protobufFrame().size());
+}
+BENCHMARK(BM_WireProtobufSerialize)->DenseRange(0, 4);
+
+static void BM_WirePackedSerialize(benchmark::State &state) {
+    Sample sample(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sample.packedFrame());
+    state.SetLabel(kindName(state.range(0)));
+    state.counters["bytes"] = static_cast<double>(sample.packedFrame().size());
+}
+BENCHMARK(BM_WirePackedSerialize)->DenseRange(0, 4);
+
+/// @brief 先解析外层 BasicMessage, 再解析 message 字段
+static void BM_WireProtobufParse(benchmark::State &state) {
+    Sample sample(state.range(0));
+    std::string frame = sample.protobufFrame();
+    std::unique_ptr<google::protobuf::Message> parsed(sample.message->New());
+    for (auto _ : state) {
+        BasicMessage envelope;
+        envelope.ParseFromString(frame);
+        parsed->ParseFromString(envelope.message());
+        benchmark::DoNotOptimize(parsed.get());
+    }
+    state.SetLabel(kindName(state.range(0)));
+    state.counters["bytes"] = static_cast<double>(frame.size());
+}
+BENCHMARK(BM_WireProtobufParse)->DenseRange(0, 4);
+
+/// @brief 客户端的读法: 校验帧头后直接在帧内读取字段
+static void BM_WirePackedView(benchmark::State &state) {
+    Sample sample(state.range(0));
+    std::string frame = sample.packedFrame();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(readInPlace(frame));
+    state.SetLabel(kindName(state.range(0)));
+    state.counters["bytes"] = static_cast<double>(frame.size());
+}
+BENCHMARK(BM_WirePackedView)->DenseRange(0, 4);
+
+/// @brief 服务器的读法: 还原为 protobuf 消息后沿用原来的处理逻辑
+static void BM_WirePackedDecode(benchmark::State &state) {
+    Sample sample(state.range(0));
+    std::string frame = sample.packedFrame();
+    std::unique_ptr<google::protobuf::Message> parsed(sample.message->New());
+    for (auto _ : state) {
+        util::decodePacked(sample.type, frame.data() + sizeof(wire::Header), frame.size() - sizeof(wire::Header),
+                           *parsed);
+        benchmark::DoNotOptimize(parsed.get());
+    }
+    state.SetLabel(kindName(state.range(0)));
+    state.counters["bytes"] = static_cast<double>(frame.size());
+}
+BENCHMARK(BM_WirePackedDecode)->DenseRange(0, 4);
@@ -5,10 +5,12 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <QTimer>
 
 #include "../ui/ui_clientwindow.h"
 #include "../../communicator/communicator.h"
+#include "command.pb.h"
 #include "card.h"
 #include "player.h"
 
@@ -45,26 +47,32 @@ private:
     bool my_turn = false;
     int target_id = -1;
     int now_turn_id = -1;
+    bool panel_built = false;       // 玩家面板每局只建一次, 之后的状态消息只更新变化的字段
+    int self_hp = -1, self_mp = -1;
 
     TurnType_pb turn_type = TurnType_pb::ACTIVE;
 
     std::vector<std::unique_ptr<Card>> CardsInHand;
     std::vector<std::unique_ptr<Player>> PlayersInGame;
+    std::unordered_map<unsigned, Player *> PlayerById;
 
     void Log(const std::string &msg);
     void GameStart(const BasicMessage &message);
     void SetMyID(const BasicMessage &message);
     void SetGameStatus(const BasicMessage &message);
+    void BuildPlayerPanel(const GameStatus &status);
     void NewCard(const BasicMessage &message);
     void DiscardCard(const BasicMessage &message);
     void YourTurn(const BasicMessage &message);
     void NoticeCard(const BasicMessage &message);
+    void ActionReject(const BasicMessage &message);
     void SetMyTurn(bool turn);
     void NoticeDying(const BasicMessage &message);
     void NoticeDead(const BasicMessage &message);
     void GameOver(const BasicMessage &message);
 
 public slots:
+    void BatchHandler(const MessageBatch &messages);
     void SignalHandler(const BasicMessage &message);
     void DiscardAction();
     void PlayAction();
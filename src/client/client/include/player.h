@@ -36,16 +36,21 @@ public:
     int GetMP() const { return mp; }
     bool IsDead() const { return is_dead; }
     void SetDead();
-    void UpdateStatus(int hp, int mp, int card_cnt, bool is_lord, bool is_now_turn);
+    void UpdateStatus(int hp, int mp, int card_cnt, bool is_lord, bool is_now_turn, bool is_alive);
     void SetDying(bool);
 
 private:
     bool now_turn = false;
     unsigned id;
-    int hp, mp;
+    // 上一次显示的值, 状态更新时只改动变化了的控件; -1 表示尚未显示
+    int hp = -1, mp = -1;
+    int card_cnt = -1;
+    int is_lord = -1;
     bool is_dead = false;
+    bool is_dying = false;
     bool is_target = false;
     void SetupUi();
+    void UpdateBorder();
 
 public slots:
     void TargetChangeNotice(unsigned target_id);
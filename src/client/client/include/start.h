@@ -29,7 +29,7 @@ private:
 
 public slots:
     void GameStart();
-    void ShutDown(const BasicMessage &message);
+    void ShutDown(const MessageBatch &messages);
 };
 
 #endif //KINGDOM_CARD_START_H
@@ -1,4 +1,5 @@
 #include <QMessageBox>
+#include <chrono>
 #include "../include/client.h"
 #include "command.pb.h"
 
@@ -13,7 +14,7 @@ ClientWindow::ClientWindow(QWidget *parent)
     ui->GameTable->setReadOnly(true);
     ui->GameTable->appendPlainText(QString("欢迎游玩三国杀，游戏即将开始，请做好准备！\n"));
 
-    connect(&Communicator::communicator(), &Communicator::messageRecv, this, &ClientWindow::SignalHandler);
+    connect(&Communicator::communicator(), &Communicator::messagesRecv, this, &ClientWindow::BatchHandler);
 
     timer = new QTimer(this);
     // 30s to 100%
@@ -34,6 +35,14 @@ ClientWindow::~ClientWindow()
     delete timer;
 }
 
+void ClientWindow::BatchHandler(const MessageBatch &messages) {
+    // 一批消息处理完再统一重绘, 多人回合的连串状态与出牌通知只触发一次布局
+    setUpdatesEnabled(false);
+    for (const auto &message : messages)
+        SignalHandler(message);
+    setUpdatesEnabled(true);
+}
+
 void ClientWindow::SignalHandler(const BasicMessage &message) {
     SIGNALS signal = message.type();
     switch (signal) {
@@ -58,6 +67,9 @@ void ClientWindow::SignalHandler(const BasicMessage &message) {
         case SIGNALS::NOTICE_CARD:
             NoticeCard(message);
             break;
+        case SIGNALS::ACTION_REJECT:
+            ActionReject(message);
+            break;
         case SIGNALS::NOTICE_DYING:
             NoticeDying(message);
             break;
@@ -95,75 +107,80 @@ void ClientWindow::SetMyID(const BasicMessage &message) {
 }
 
 void ClientWindow::SetGameStatus(const BasicMessage &message) {
-    static bool inited = false;
     GameStatus status;
     status.ParseFromString(message.message());
     QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::SetGameStatus: currentturnplayerid: " << status.currentturnplayerid()
                                  << " totalplayers: " << status.totalplayers();
+    if (!panel_built)
+        BuildPlayerPanel(status);
+    if (now_turn_id != static_cast<int>(status.currentturnplayerid()))
+        Log("当前回合玩家 ID：" + std::to_string(status.currentturnplayerid())
+            + (status.currentturnplayerid() == my_id ? "，是您的回合" : "") + "\n");
     now_turn_id = status.currentturnplayerid();
-    if (!inited) {
-        for (int i = 0; i < status.totalplayers(); ++i) {
-            if (status.players(i).id() == my_id) {
-                connect(this, &ClientWindow::targetChange, this, [this](unsigned target_id) {
-                    if (target_id == my_id) {
-                        ui->SelfCard->setStyleSheet("border: 2px solid red");
-                        ui->SelfCard->setText("（已选中）");
-                    } else {
-                        if (now_turn_id == my_id)
-                            ui->SelfCard->setStyleSheet("border: 2px solid green");
-                        else
-                            ui->SelfCard->setStyleSheet("border: 1px solid black");
-                        ui->SelfCard->setText("");
-                    }
-                });
-                connect(ui->SelfCard, &QPushButton::clicked, this, [this]() {
-                    if (this->target_id == my_id) {
-                        this->target_id = -1;
-                    } else {
-                        this->target_id = my_id;
-                    }
-                    emit targetChange(target_id);
-                });
-                continue;
-            }
-            PlayersInGame.emplace_back(new Player(status.players(i).id()));
-            ui->PlayerBox->addLayout(PlayersInGame.back().get());
-            connect(this, &ClientWindow::targetChange, PlayersInGame.back().get(), &Player::TargetChangeNotice);
-            connect(PlayersInGame.back().get()->PlayerCard.get(), &QPushButton::clicked, this,
-                    [this, id = status.players(i).id()]() {
-                        if (this->target_id == id) {
-                            this->target_id = -1;
-                        } else {
-                            this->target_id = id;
-                        }
-                        emit targetChange(target_id);
-                    });
-        }
-        inited = true;
-    }
-    Log("当前回合玩家 ID：" + std::to_string(status.currentturnplayerid())
-        + (status.currentturnplayerid() == my_id ? "，是您的回合" : "") + "\n");
     if (status.currentturnplayerid() != my_id) {
         SetMyTurn(false);
         ui->progressBar->setValue(0);
         ui->progressBar->setDisabled(true);
         timer->start(time_interval);
     }
-    for (int i = 0; i < status.totalplayers(); ++i) {
-        if (status.players(i).id() == my_id) {
-            ui->SelfHP->setText(QString::fromStdString("HP: " + std::to_string(status.players(i).hp())
-                                                       + "/" + std::to_string(status.players(i).maxhp())));
+    for (const auto &player : status.players()) {
+        if (player.id() == my_id) {
+            if (static_cast<int>(player.hp()) != self_hp || static_cast<int>(player.maxhp()) != self_mp) {
+                self_hp = static_cast<int>(player.hp());
+                self_mp = static_cast<int>(player.maxhp());
+                ui->SelfHP->setText(QString::fromStdString("HP: " + std::to_string(self_hp)
+                                                           + "/" + std::to_string(self_mp)));
+            }
             continue;
         }
-        for (int j = 0; j < PlayersInGame.size(); ++j) {
-            if (PlayersInGame[j]->GetID() == status.players(i).id()) {
-                PlayersInGame[j]->UpdateStatus(status.players(i).hp(), status.players(i).maxhp(),
-                                               status.players(i).cardcnt(),
-                                               status.players(i).id() == lord_id,
-                                               status.players(i).id() == status.currentturnplayerid());
-                break;
-            }
+        auto it = PlayerById.find(player.id());
+        if (it != PlayerById.end())
+            it->second->UpdateStatus(player.hp(), player.maxhp(), player.cardcnt(),
+                                     player.id() == lord_id, player.id() == status.currentturnplayerid(),
+                                     player.isalive());
+    }
+}
+
+/// 收到第一条状态消息时建立玩家面板, 信号只在这里连接一次
+void ClientWindow::BuildPlayerPanel(const GameStatus &status) {
+    panel_built = true;
+    for (const auto &player : status.players()) {
+        if (player.id() == my_id) {
+            connect(this, &ClientWindow::targetChange, this, [this](unsigned target_id) {
+                if (target_id == my_id) {
+                    ui->SelfCard->setStyleSheet("border: 2px solid red");
+                    ui->SelfCard->setText("（已选中）");
+                } else {
+                    if (now_turn_id == my_id)
+                        ui->SelfCard->setStyleSheet("border: 2px solid green");
+                    else
+                        ui->SelfCard->setStyleSheet("border: 1px solid black");
+                    ui->SelfCard->setText("");
+                }
+            });
+            connect(ui->SelfCard, &QPushButton::clicked, this, [this]() {
+                if (this->target_id == my_id) {
+                    this->target_id = -1;
+                } else {
+                    this->target_id = my_id;
+                }
+                emit targetChange(target_id);
+            });
+            continue;
         }
+        PlayersInGame.emplace_back(new Player(player.id()));
+        PlayerById[player.id()] = PlayersInGame.back().get();
+        ui->PlayerBox->addLayout(PlayersInGame.back().get());
+        connect(this, &ClientWindow::targetChange, PlayersInGame.back().get(), &Player::TargetChangeNotice);
+        connect(PlayersInGame.back().get()->PlayerCard.get(), &QPushButton::clicked, this,
+                [this, id = player.id()]() {
+                    if (this->target_id == id) {
+                        this->target_id = -1;
+                    } else {
+                        this->target_id = id;
+                    }
+                    emit targetChange(target_id);
+                });
     }
 }
 //void ClientWindow::StartGame(const BasicMessage &message) {
@@ -206,9 +223,16 @@ void ClientWindow::YourTurn(const BasicMessage &message) {
     SetMyTurn(true);
     class YourTurn your_turn;
     your_turn.ParseFromString(message.message());
-    QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::YourTurn: remainingtime: " << your_turn.remainingtime()
-        << " turntype: " << your_turn.turntype();
-    Log("您的回合，剩余时间：" + std::to_string(your_turn.remainingtime()) + "ms\n");
+    // 已同步时钟时按截止时刻计算剩余时间, 扣除消息在路上与排队的时间
+    float remaining = your_turn.remainingtime();
+    if (your_turn.deadline() != 0)
+        remaining = static_cast<float>(your_turn.deadline() - std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    if (remaining < 0)
+        remaining = 0;
+    QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::YourTurn: remainingtime: " << remaining
+        << " deadline: " << your_turn.deadline() << " turntype: " << your_turn.turntype();
+    Log("您的回合，剩余时间：" + std::to_string(static_cast<int>(remaining)) + "ms\n");
     turn_type = your_turn.turntype();
 
     for (auto & card : CardsInHand) {
@@ -223,7 +247,7 @@ void ClientWindow::YourTurn(const BasicMessage &message) {
             }
     }
 
-    unsigned time = ui->progressBar->maximum() - your_turn.remainingtime() / time_interval;
+    unsigned time = ui->progressBar->maximum() - remaining / time_interval;
     if (time > ui->progressBar->maximum()) {
         time = ui->progressBar->maximum();
     } else if (time < ui->progressBar->minimum()) {
@@ -246,6 +270,18 @@ void ClientWindow::NoticeCard(const BasicMessage &message) {
         + UTILS::CardName[notice_card.card().type()] + "\n");
 }
 
+void ClientWindow::ActionReject(const BasicMessage &message) {
+    class ActionReject reject;
+    reject.ParseFromString(message.message());
+    QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::ActionReject: card.id: " << reject.card().id()
+                                 << " reason: " << reject.reason();
+    Log("出牌被拒绝：" + UTILS::RejectReasonName[reject.reason()] + "\n");
+    // 出牌时已从手牌中移除, 拒绝后放回, 服务端仍在等待本回合出牌
+    CardsInHand.emplace_back(new Card(reject.card().id(), reject.card().type()));
+    ui->CardBox->addWidget(CardsInHand.back().get());
+    SetMyTurn(true);
+}
+
 void ClientWindow::DiscardAction() {
     ActionPass action;
     for (int i = 0; i < CardsInHand.size(); ++i) {
@@ -295,12 +331,9 @@ void ClientWindow::NoticeDying(const BasicMessage &message) {
     notice_dying.ParseFromString(message.message());
     QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::NoticeDying: playerid: " << notice_dying.playerid();
     Log("玩家 " + std::to_string(notice_dying.playerid()) + " 即将死亡，等待救援\n");
-    for (auto & player : PlayersInGame) {
-        if (player->GetID() == notice_dying.playerid()) {
-            player->SetDying(true);
-            break;
-        }
-    }
+    auto it = PlayerById.find(notice_dying.playerid());
+    if (it != PlayerById.end())
+        it->second->SetDying(true);
 }
 
 void ClientWindow::NoticeDead(const BasicMessage &message) {
@@ -308,12 +341,9 @@ void ClientWindow::NoticeDead(const BasicMessage &message) {
     notice_dead.ParseFromString(message.message());
     QDebug(QtMsgType::QtInfoMsg) << "ClientWindow::NoticeDead: playerid: " << notice_dead.playerid();
     Log("玩家 " + std::to_string(notice_dead.playerid()) + " 已死亡\n");
-    for (auto & player : PlayersInGame) {
-        if (player->GetID() == notice_dead.playerid()) {
-            player->SetDead();
-            break;
-        }
-    }
+    auto it = PlayerById.find(notice_dead.playerid());
+    if (it != PlayerById.end())
+        it->second->SetDead();
 }
 
 void ClientWindow::GameOver(const BasicMessage &message) {
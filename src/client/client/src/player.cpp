@@ -31,45 +31,58 @@ Player::Player(unsigned id, QVBoxLayout *parent) : id(id) {
     SetupUi();
 }
 
-void Player::UpdateStatus(int hp, int mp, int card_cnt, bool is_lord, bool is_now_turn) {
-    this->hp = hp;
-    this->mp = mp;
-    PlayerHP->setText("HP: " + QString::number(hp) + "/" + QString::number(mp));
-    PlayerCardCnt->setText("手牌数： " + QString::number(card_cnt));
-    PlayerIdentity->setText(is_lord ? "身份： 主公" : "身份： 未知");
+/// 与上一次显示的值比较, 只改动变化了的控件, 避免每条状态消息都重设文字与样式表
+void Player::UpdateStatus(int hp, int mp, int card_cnt, bool is_lord, bool is_now_turn, bool is_alive) {
+    if (hp != this->hp || mp != this->mp) {
+        this->hp = hp;
+        this->mp = mp;
+        PlayerHP->setText("HP: " + QString::number(hp) + "/" + QString::number(mp));
+    }
+    if (card_cnt != this->card_cnt) {
+        this->card_cnt = card_cnt;
+        PlayerCardCnt->setText("手牌数： " + QString::number(card_cnt));
+    }
+    if (static_cast<int>(is_lord) != this->is_lord) {
+        this->is_lord = is_lord;
+        PlayerIdentity->setText(is_lord ? "身份： 主公" : "身份： 未知");
+    }
     if (is_dead)
         return;
-    if (is_now_turn) {
-        PlayerCard->setStyleSheet("border: 2px solid green");
-    } else {
-        PlayerCard->setStyleSheet("border: 1px solid black");
+    if (!is_alive) {
+        SetDead();
+        return;
     }
-    if (is_target) {
-        PlayerCard->setStyleSheet("border: 2px solid red");
-        PlayerCard->setText("（已选中）");
-    } else {
-        PlayerCard->setText("");
+    // 濒死的提示保留到下一次状态更新
+    if (is_now_turn != now_turn || is_dying) {
+        now_turn = is_now_turn;
+        is_dying = false;
+        UpdateBorder();
     }
-    now_turn = is_now_turn;
 }
 
-void Player::TargetChangeNotice(unsigned target_id) {
-    if (target_id == id) {
+void Player::UpdateBorder() {
+    if (is_dying)
+        PlayerCard->setStyleSheet("border: 2px solid yellow");
+    else if (is_target)
         PlayerCard->setStyleSheet("border: 2px solid red");
-        PlayerCard->setText("（已选中）");
-        is_target = true;
-    } else {
-        if (now_turn) {
-            PlayerCard->setStyleSheet("border: 2px solid green");
-        } else {
-            PlayerCard->setStyleSheet("border: 1px solid black");
-        }
-        PlayerCard->setText("");
-        is_target = false;
-    }
+    else if (now_turn)
+        PlayerCard->setStyleSheet("border: 2px solid green");
+    else
+        PlayerCard->setStyleSheet("border: 1px solid black");
+}
+
+void Player::TargetChangeNotice(unsigned target_id) {
+    // 选中目标的变化会通知所有玩家, 只有选中状态变化的那一两个需要重绘
+    if (is_dead || (target_id == id) == is_target)
+        return;
+    is_target = target_id == id;
+    PlayerCard->setText(is_target ? "（已选中）" : "");
+    UpdateBorder();
 }
 
 void Player::SetDead() {
+    if (is_dead)
+        return;
     is_dead = true;
     PlayerCard->setStyleSheet("border: 2px solid black");
     PlayerCard->setText("（已死亡）");
@@ -77,13 +90,8 @@ void Player::SetDead() {
 }
 
 void Player::SetDying(bool dying) {
-    if (dying) {
-        PlayerCard->setStyleSheet("border: 2px solid yellow");
-    } else {
-        if (now_turn) {
-            PlayerCard->setStyleSheet("border: 2px solid green");
-        } else {
-            PlayerCard->setStyleSheet("border: 1px solid black");
-        }
-    }
+    if (is_dead || dying == is_dying)
+        return;
+    is_dying = dying;
+    UpdateBorder();
 }
@@ -13,7 +13,7 @@ StartWindow::StartWindow(QWidget *parent)
     connect(ui->GameStart, &QPushButton::clicked, this, &StartWindow::GameStart);
     connect(ui->ServerAddr, &QLineEdit::returnPressed, this, &StartWindow::GameStart);
     connect(ui->ServerPort, &QLineEdit::returnPressed, this, &StartWindow::GameStart);
-    connect(&Communicator::communicator(), &Communicator::messageRecv, this, &StartWindow::ShutDown);
+    connect(&Communicator::communicator(), &Communicator::messagesRecv, this, &StartWindow::ShutDown);
 }
 
 StartWindow::~StartWindow() {
@@ -42,15 +42,18 @@ void StartWindow::GameStart() {
     ui->status_text->setText("等待服务器开始游戏");
 }
 
-void StartWindow::ShutDown(const BasicMessage &message) {
-    auto signal = message.type();
-    if (signal == SIGNALS::GAME_START) {
-        this->hide();
-    } else if (signal == SIGNALS::KICK) {
-        QMessageBox warning;
-        warning.setText("您已被踢出游戏");
-        warning.exec();
-        this->close();
+void StartWindow::ShutDown(const MessageBatch &messages) {
+    for (const auto &message : messages) {
+        auto signal = message.type();
+        if (signal == SIGNALS::GAME_START) {
+            this->hide();
+        } else if (signal == SIGNALS::KICK) {
+            QMessageBox warning;
+            warning.setText("您已被踢出游戏");
+            warning.exec();
+            this->close();
+            return;
+        }
     }
 }
 
@@ -4,21 +4,41 @@
 
 #include "communicator.h"
 #include <QDebug>
+#include <QSettings>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include "packed_wire.h"
 
 void Communicator::init(QString address, unsigned port) {
+    // inproc 须先绑定再连接, 在启动收发线程之前完成
+    communicator().outbox.bind(OUTBOX_ENDPOINT);
     communicator().thread = new Spinner(&communicator(), address, port);
     communicator().thread->start();
-    connect(&communicator(), &Communicator::messageSend, &communicator(), &Communicator::sendSignal_impl);
+    // messagesPending 由收消息的线程发出, 排队到界面线程后再决定何时投递
+    connect(&communicator(), &Communicator::messagesPending, &communicator(), &Communicator::scheduleDelivery);
+    communicator().frameTimer.setSingleShot(true);
+    connect(&communicator().frameTimer, &QTimer::timeout, &communicator(), &Communicator::deliver);
+    communicator().lastDelivery.start();
 }
 
 Communicator::~Communicator() {
+    // 置位后发一个空帧唤醒收发线程
+    isStopping = true;
+    outbox.send(zmq::message_t(), zmq::send_flags::dontwait);
     this->thread->quit();
     this->thread->wait();
     delete this->thread;
 }
 
+/// @brief 在界面线程中发出一条消息: 只写入 inproc 队列, 由收发线程转发给服务器, 不会阻塞界面
 void Communicator::sendSignal(const BasicMessage &message) {
-    emit this->messageSend(message);
+    zmq::message_t request(message.ByteSizeLong());
+    message.SerializeToArray(request.data(), request.size());
+    QDebug(QtMsgType::QtDebugMsg) << "Communicator::sendSignal: send " << message.type();
+    if (!outbox.send(request, zmq::send_flags::dontwait).has_value())
+        QDebug(QtMsgType::QtWarningMsg) << "Communicator::sendSignal: outbox full, message dropped";
 }
 
 Communicator::Spinner::Spinner(Communicator* comm, QString address, unsigned port, QObject *parent) : QThread(parent) {
@@ -28,9 +48,19 @@ Communicator::Spinner::Spinner(Communicator* comm, QString address, unsigned por
 }
 
 void Communicator::Spinner::run() {
+    // 服务器套接字只在这个线程中使用, 界面线程的消息经 inproc 队列交过来
+    zmq::socket_t outbox(communicator->context, ZMQ_PAIR);
+    outbox.connect(OUTBOX_ENDPOINT);
     communicator->socket_init.connect("tcp://" + address.toStdString() + ":" + std::to_string(port));
+    // 服务器重启后凭上次的会话令牌回到原来的座位
+    QSettings settings("KingdomCard", "client");
+    ConnectRequest connect_request;
+    connect_request.set_session_token(settings.value("session_token", 0).toULongLong());
+    // 对局中的一连串通知合为一帧, 界面本来就按批处理
+    connect_request.set_batch_frames(true);
     BasicMessage msg;
     msg.set_type(SIGNALS::CONNECT_REQ);
+    msg.set_message(connect_request.SerializeAsString());
     zmq::message_t connect_req(msg.ByteSizeLong());
     msg.SerializeToArray(connect_req.data(), connect_req.size());
     communicator->socket_init.send(connect_req, zmq::send_flags::none);
@@ -42,12 +72,21 @@ void Communicator::Spinner::run() {
     BasicMessage reply_msg;
     reply_msg.ParseFromArray(connect_rep.data(), connect_rep.size());
     QDebug(QtMsgType::QtDebugMsg) << "Communicator::spin: recv CONNECT_ACK";
+    if (reply_msg.type() == KICK) {
+        // 服务器正在恢复的对局中没有这个令牌, 下次以新玩家身份连接
+        QDebug(QtMsgType::QtWarningMsg) << "Communicator::spin: session token rejected";
+        settings.remove("session_token");
+        return;
+    }
     ConnectResponse connect_ack;
     connect_ack.ParseFromString(reply_msg.message());
-    emit communicator->messageRecv(reply_msg);
+    communicator->post(MessageBatch{reply_msg});
     QDebug(QtMsgType::QtInfoMsg) << "Communicator::spin: player_id: " << connect_ack.player_id() << " port: " << connect_ack.port();
+    settings.setValue("session_token", QVariant::fromValue<qulonglong>(connect_ack.session_token()));
     // 连接服务器
-    communicator->socket.connect("tcp://" + address.toStdString() + ":" + std::to_string(connect_ack.port()));
+    communicator->socket.connect(!connect_ack.endpoint().empty()
+                                 ? connect_ack.endpoint()
+                                 : "tcp://" + address.toStdString() + ":" + std::to_string(connect_ack.port()));
 
     // 发送连接确认
     BasicMessage connect_ack_m;
@@ -58,15 +97,10 @@ void Communicator::Spinner::run() {
     communicator->socket.send(connect_ack_z, zmq::send_flags::none);
 
     communicator->player_id = connect_ack.player_id();
-    while (true) {
-        zmq::message_t request;
-        auto rtn = communicator->socket.recv(request, zmq::recv_flags::none);
-        if (!rtn.has_value()) {
-            QDebug(QtMsgType::QtWarningMsg) << "Communicator::spin: recv failed";
-            continue;
-        }
+    MessageBatch batch;
+    auto handle = [&](const char *data, size_t size) {
         BasicMessage message;
-        message.ParseFromArray(request.data(), request.size());
+        message.ParseFromArray(data, static_cast<int>(size));
 
         QDebug(QtMsgType::QtDebugMsg) << "Communicator::spin: recv " << message.type();
         if (message.type() == CONNECT_ACK) {
@@ -76,16 +110,114 @@ void Communicator::Spinner::run() {
             zmq::message_t ack_z(ack_m.ByteSizeLong());
             ack_m.SerializeToArray(ack_z.data(), ack_z.size());
             communicator->socket.send(ack_z, zmq::send_flags::none);
-        } else
-            emit communicator->messageRecv(message);
+        } else if (message.type() == CLOCK_SYNC) {
+            // 在收消息的线程里立即填入本地时刻, 不经过界面线程的事件队列
+            ClockSync sync;
+            sync.ParseFromString(message.message());
+            sync.set_client_time(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            BasicMessage sync_m;
+            sync_m.set_type(SIGNALS::CLOCK_SYNC);
+            sync_m.set_message(sync.SerializeAsString());
+            zmq::message_t sync_z(sync_m.ByteSizeLong());
+            sync_m.SerializeToArray(sync_z.data(), sync_z.size());
+            communicator->socket.send(sync_z, zmq::send_flags::none);
+        } else {
+            // 对局结束后令牌失效
+            if (message.type() == GAME_OVER)
+                settings.remove("session_token");
+            batch.emplace_back(std::move(message));
+        }
+    };
+    std::array<zmq::pollitem_t, 2> items{{{communicator->socket, 0, ZMQ_POLLIN, 0},
+                                          {outbox, 0, ZMQ_POLLIN, 0}}};
+    while (true) {
+        try {
+            zmq::poll(items.data(), items.size(), std::chrono::milliseconds(-1));
+        } catch (zmq::error_t &e) {
+            QDebug(QtMsgType::QtWarningMsg) << "Communicator::spin: poll failed: " << e.what();
+            continue;
+        }
+        if (communicator->isStopping)
+            return;
+        // 先把界面线程交来的消息转发给服务器
+        zmq::message_t outgoing;
+        while ((items[1].revents & ZMQ_POLLIN) && outbox.recv(outgoing, zmq::recv_flags::dontwait).has_value())
+            communicator->socket.send(outgoing, zmq::send_flags::none);
+        if (!(items[0].revents & ZMQ_POLLIN))
+            continue;
+        // 把已经到达的消息一次收完再交给界面线程
+        zmq::message_t request;
+        while (communicator->socket.recv(request, zmq::recv_flags::dontwait).has_value()) {
+            const auto *data = static_cast<const char *>(request.data());
+            const wire::Batch *frame = wire::batch(data, request.size());
+            if (frame == nullptr) {
+                handle(data, request.size());
+                continue;
+            }
+            // 合并帧: 没有申请压缩, 拆开后逐条处理
+            if ((frame->flags & wire::BATCH_ZSTD)
+                || !wire::forEachInBatch(data + sizeof(wire::Batch), request.size() - sizeof(wire::Batch), handle))
+                QDebug(QtMsgType::QtWarningMsg) << "Communicator::spin: malformed batch frame dropped";
+        }
+        if (!batch.empty())
+            communicator->post(std::move(batch));
+        batch.clear();
     }
 }
 
-void Communicator::sendSignal_impl(const BasicMessage &message) {
-    zmq::message_t request(message.ByteSizeLong());
-    message.SerializeToArray(request.data(), request.size());
-    QDebug(QtMsgType::QtDebugMsg) << "Communicator::sendSignal_impl: send " << message.type();
-    socket.send(request, zmq::send_flags::none);
+/// @brief 收消息的线程把一批消息交给界面线程, 只在待投递的队列由空变为非空时通知一次
+void Communicator::post(MessageBatch &&messages) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx);
+        was_empty = pending.empty();
+        if (was_empty)
+            pending.swap(messages);
+        else
+            std::move(messages.begin(), messages.end(), std::back_inserter(pending));
+    }
+    if (was_empty)
+        emit messagesPending();
+}
+
+/// @brief 在界面线程中安排投递: 距上次投递已满一帧时在下一轮事件循环投递, 否则等到这一帧结束
+void Communicator::scheduleDelivery() {
+    if (frameTimer.isActive())
+        return;
+    frameTimer.start(std::max<int>(0, FRAME_INTERVAL - static_cast<int>(lastDelivery.elapsed())));
+}
+
+/// @brief 取走这一帧攒下的全部消息, 合并后整批交给界面
+void Communicator::deliver() {
+    MessageBatch messages;
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx);
+        messages.swap(pending);
+    }
+    lastDelivery.restart();
+    if (messages.empty())
+        return;
+    coalesce(messages);
+    emit messagesRecv(messages);
+}
+
+/// @brief 合并状态更新: GAME_STATUS 是完整的快照, 两次之间只有出牌通知时前一次不必再处理
+void Communicator::coalesce(MessageBatch &messages) {
+    MessageBatch merged;
+    merged.reserve(messages.size());
+    size_t last_status = messages.size();   // merged 中仍可被后一次状态替换的 GAME_STATUS
+    for (auto &message : messages) {
+        if (message.type() == GAME_STATUS) {
+            if (last_status != messages.size())
+                merged.erase(merged.begin() + static_cast<std::ptrdiff_t>(last_status));
+            last_status = merged.size();
+        } else if (message.type() != NOTICE_CARD) {
+            last_status = messages.size();
+        }
+        merged.emplace_back(std::move(message));
+    }
+    messages.swap(merged);
 }
 
 Communicator *Communicator::instance = nullptr;
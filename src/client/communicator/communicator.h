@@ -7,14 +7,25 @@
 
 #include "commands.h"
 #include "../utils/utils.h"
+#include <QElapsedTimer>
 #include <QObject>
 #include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <zmq.hpp>
 #include "basic_message.pb.h"
 
+/// @brief 收到的消息先在收消息的线程里攒成一批, 界面线程每帧至多处理一批
+typedef std::vector<BasicMessage> MessageBatch;
+
 class Communicator : public QObject {
     Q_OBJECT
 
+    static constexpr int FRAME_INTERVAL = 16;   // 两次向界面投递之间至少间隔的毫秒数
+    static constexpr char const *OUTBOX_ENDPOINT = "inproc://kc-client-outbox";
+
 public:
     static Communicator& communicator() {
         if (instance == nullptr)
@@ -25,20 +36,31 @@ public:
     static void init(QString address, unsigned port);
 
 signals:
-    void messageSend(const BasicMessage message);
-    void messageRecv(BasicMessage message);
+    void messagesRecv(const MessageBatch &messages);
+    void messagesPending();
 public slots:
     void sendSignal(const BasicMessage &message);
 
+private slots:
+    void scheduleDelivery();
+    void deliver();
+
 private:
     static Communicator *instance;
     QThread *thread;
     zmq::context_t context {1};
     zmq::socket_t socket_init {context, ZMQ_REQ};
-    zmq::socket_t socket {context, ZMQ_PAIR};
+    zmq::socket_t socket {context, ZMQ_PAIR};     // 与服务器的连接, 只由收发线程使用
+    zmq::socket_t outbox {context, ZMQ_PAIR};     // 界面线程一端, 发出的消息经它交给收发线程
+    std::atomic<bool> isStopping {false};
     unsigned player_id = -1;
+    std::mutex pendingMtx;
+    MessageBatch pending;           // 收消息的线程放入, 界面线程整批取走
+    QTimer frameTimer;
+    QElapsedTimer lastDelivery;
 
-    void sendSignal_impl(const BasicMessage &message);
+    void post(MessageBatch &&messages);
+    static void coalesce(MessageBatch &messages);
 
     class Spinner : public QThread {
         QString address;
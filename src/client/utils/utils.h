@@ -18,6 +18,19 @@ namespace UTILS {
             "反贼",
             "内奸"
     };
+
+    std::string const RejectReasonName[] = {
+            "合法",
+            "手牌中没有这张牌",
+            "牌的类型不匹配",
+            "当前不能打出这种牌",
+            "目标玩家不存在",
+            "不能以自己为目标",
+            "目标已经死亡",
+            "满血不能使用桃",
+            "弃牌重复",
+            "弃牌数量过少"
+    };
 }
 
 #endif //KINGDOM_CARD_UTILS_H
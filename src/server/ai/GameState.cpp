@@ -0,0 +1,287 @@
+
+#include "GameState.h"
+
+#include <algorithm>
+
+namespace kc::ai {
+    /// @brief 根据信息集随机生成一个与之相容的完整状态
+    /// @details 自己以外的手牌与牌堆由未知牌随机分配, 除主公与自己外的身份按身份表随机分配
+    GameState GameState::determinize(const Observation &obs, Rng &rng) {
+        GameState st;
+        st.playerCount = obs.playerCount;
+        st.current = obs.self;
+        st.lordSeat = obs.lordSeat;
+        st.playsThisTurn = obs.playsThisTurn;
+        st.slashed = obs.slashed;
+        st.drawPerTurn = obs.drawPerTurn;
+        st.hp = obs.hp;
+        st.maxHp = obs.maxHp;
+        st.alive = obs.alive;
+
+        // 身份
+        std::array<uint8_t, MAX_PLAYER_NUM> pool{};
+        size_t pool_size = 0;
+        for (int idt = 0; idt < 4; ++idt) {
+            size_t count = obs.identityCount[idt];
+            if (idt + 1 == LORD)
+                --count;
+            if (idt + 1 == obs.selfIdentity && obs.selfIdentity != LORD)
+                --count;
+            for (size_t i = 0; i < count; ++i)
+                pool[pool_size++] = idt + 1;
+        }
+        for (size_t i = pool_size; i > 1; --i)
+            std::swap(pool[i - 1], pool[rng.below(i)]);
+        for (uint8_t seat = 0, k = 0; seat < obs.playerCount; ++seat) {
+            if (seat == obs.self)
+                st.identity[seat] = obs.selfIdentity;
+            else if (seat == obs.lordSeat)
+                st.identity[seat] = LORD;
+            else
+                st.identity[seat] = k < pool_size ? pool[k++] : static_cast<uint8_t>(REBEL);
+        }
+
+        // 手牌与牌堆
+        std::array<uint8_t, DECK_CARD_COUNT> unknown{};
+        size_t unknown_size = 0;
+        for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t)
+            for (size_t i = obs.ownHand[t]; i < obs.cardCount[t]; ++i)
+                unknown[unknown_size++] = t;
+        for (size_t i = unknown_size; i > 1; --i)
+            std::swap(unknown[i - 1], unknown[rng.below(i)]);
+        size_t next = 0;
+        for (uint8_t seat = 0; seat < obs.playerCount; ++seat) {
+            if (seat == obs.self) {
+                st.hand[seat] = obs.ownHand;
+                for (auto c : obs.ownHand)
+                    st.handSize[seat] += c;
+                continue;
+            }
+            for (size_t i = 0; i < obs.handSize[seat] && next < unknown_size; ++i) {
+                ++st.hand[seat][unknown[next++]];
+                ++st.handSize[seat];
+            }
+        }
+        for (; next < unknown_size; ++next)
+            st.deck[st.deckCount++] = unknown[next];
+        return st;
+    }
+
+    /// @brief 生成当前玩家主动出牌阶段的所有合法动作
+    void GameState::generateMoves(MoveList &moves) const {
+        moves.size = 0;
+        uint32_t active = cardMask(TurnType::ACTIVE);
+        if (playsThisTurn < MAX_PLAYS_PER_TURN) {
+            for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t) {
+                if (!(active & (1u << t)) || hand[current][t] == 0)
+                    continue;
+                switch (t) {
+                    case CardType::SLASH:
+                        if (slashed)
+                            break;
+                        [[fallthrough]];
+                    case CardType::DUEL:
+                        for (uint8_t seat = 0; seat < playerCount; ++seat)
+                            if (seat != current && alive[seat])
+                                moves.push({t, seat});
+                        break;
+                    case CardType::DISMANTLE:
+                    case CardType::STEAL:
+                        for (uint8_t seat = 0; seat < playerCount; ++seat)
+                            if (seat != current && alive[seat] && handSize[seat] > 0)
+                                moves.push({t, seat});
+                        break;
+                    case CardType::PEACH:
+                        if (hp[current] < maxHp[current])
+                            moves.push({t, current});
+                        break;
+                    default:
+                        moves.push({t, current});
+                        break;
+                }
+            }
+        }
+        moves.push({Move::END_TURN, current});
+    }
+
+    /// @brief 执行一步动作, 结算规则与 GameController::dealWithCard 一致, 反应采用默认策略
+    void GameState::apply(Move move, Rng &rng) {
+        if (move.isEndTurn()) {
+            endTurn(rng);
+            return;
+        }
+        discard(current, move.type);
+        ++playsThisTurn;
+        uint8_t target = move.target;
+        switch (move.type) {
+            case CardType::SLASH:
+                slashed = 1;
+                if (!react(target, TurnType::DODGE_WAIT))
+                    damage(target);
+                break;
+            case CardType::PEACH:
+                if (hp[current] < maxHp[current])
+                    ++hp[current];
+                break;
+            case CardType::DISMANTLE:
+                if (!react(target, TurnType::PASSIVE) && handSize[target] > 0)
+                    discardRandom(target, rng);
+                break;
+            case CardType::STEAL:
+                if (!react(target, TurnType::PASSIVE) && handSize[target] > 0)
+                    discardRandom(target, rng, current);
+                break;
+            case CardType::DUEL:
+                if (!react(target, TurnType::PASSIVE_SLASH))
+                    damage(target);
+                else
+                    while (true) {
+                        if (!react(current, TurnType::DUELING)) {
+                            damage(current);
+                            break;
+                        }
+                        if (!react(target, TurnType::DUELING)) {
+                            damage(target);
+                            break;
+                        }
+                    }
+                break;
+            case CardType::ARCHERY_VOLLEY:
+            case CardType::BARBARIAN: {
+                TurnType type = move.type == CardType::ARCHERY_VOLLEY ? TurnType::PASSIVE_DODGE
+                                                                      : TurnType::PASSIVE_SLASH;
+                for (uint8_t i = 1; i < playerCount && !isTerminal(); ++i) {
+                    uint8_t seat = (current + i) % playerCount;
+                    if (alive[seat] && !react(seat, type))
+                        damage(seat);
+                }
+                break;
+            }
+            case CardType::SLEIGHT_OF_HAND:
+                draw(current, 2);
+                break;
+            case CardType::HARVEST_FEAST:
+                for (uint8_t seat = 0; seat < playerCount; ++seat)
+                    if (alive[seat])
+                        draw(seat, 2);
+                break;
+            case CardType::PEACH_GARDEN_OATH:
+                for (uint8_t seat = 0; seat < playerCount; ++seat)
+                    if (alive[seat] && hp[seat] < maxHp[seat])
+                        ++hp[seat];
+                break;
+            default:
+                break;
+        }
+        if (!isTerminal() && !alive[current])
+            endTurn(rng);
+    }
+
+    /// @brief 对某个座位的收益, 所属阵营胜利为 1, 失败为 0, 未分胜负为 0.5
+    double GameState::reward(uint8_t seat) const {
+        if (winner == UNKNOWN)
+            return 0.5;
+        uint8_t idt = identity[seat];
+        if (winner == LORD)
+            return idt == LORD || idt == MINISTER ? 1.0 : 0.0;
+        return idt == winner ? 1.0 : 0.0;
+    }
+
+    void GameState::draw(uint8_t seat, size_t count) {
+        for (size_t i = 0; i < count && deckCount > 0; ++i) {
+            uint8_t type = deck[deckHead];
+            deckHead = (deckHead + 1) % DECK_CARD_COUNT;
+            --deckCount;
+            ++hand[seat][type];
+            ++handSize[seat];
+        }
+    }
+
+    void GameState::discard(uint8_t seat, uint8_t type) {
+        --hand[seat][type];
+        --handSize[seat];
+        deck[(deckHead + deckCount) % DECK_CARD_COUNT] = type;
+        ++deckCount;
+    }
+
+    /// @brief 随机移除一张手牌, to_seat 有效时交给该座位, 否则放回牌堆
+    void GameState::discardRandom(uint8_t seat, Rng &rng, uint8_t to_seat) {
+        uint32_t idx = rng.below(handSize[seat]);
+        for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t) {
+            if (idx < hand[seat][t]) {
+                if (to_seat < playerCount) {
+                    --hand[seat][t];
+                    --handSize[seat];
+                    ++hand[to_seat][t];
+                    ++handSize[to_seat];
+                } else {
+                    discard(seat, t);
+                }
+                return;
+            }
+            idx -= hand[seat][t];
+        }
+    }
+
+    /// @brief 默认反应策略: 有可用的牌就打出, 优先保留无懈可击
+    bool GameState::react(uint8_t seat, TurnType type) {
+        uint32_t mask = cardMask(type);
+        uint8_t chosen = CARD_TYPE_COUNT;
+        for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t)
+            if ((mask & (1u << t)) && hand[seat][t] > 0
+                && (chosen == CARD_TYPE_COUNT || chosen == CardType::UNRELENTING))
+                chosen = t;
+        if (chosen == CARD_TYPE_COUNT)
+            return false;
+        discard(seat, chosen);
+        return true;
+    }
+
+    void GameState::damage(uint8_t seat) {
+        if (!alive[seat])
+            return;
+        if (hp[seat] > 1) {
+            --hp[seat];
+            return;
+        }
+        // 濒死, 只有自己的桃能救
+        if (hand[seat][CardType::PEACH] > 0) {
+            discard(seat, CardType::PEACH);
+            hp[seat] = 1;
+            return;
+        }
+        hp[seat] = 0;
+        alive[seat] = 0;
+        for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t)
+            while (hand[seat][t] > 0)
+                discard(seat, t);
+        checkWin();
+    }
+
+    void GameState::endTurn(Rng &rng) {
+        while (alive[current] && handSize[current] > hp[current])
+            discardRandom(current, rng);
+        for (uint8_t i = 1; i <= playerCount; ++i) {
+            uint8_t seat = (current + i) % playerCount;
+            if (alive[seat]) {
+                current = seat;
+                break;
+            }
+        }
+        playsThisTurn = 0;
+        slashed = 0;
+        draw(current, drawPerTurn);
+    }
+
+    /// @brief 胜负判定与 GameController::checkWin 一致
+    void GameState::checkWin() {
+        size_t count[4] = {0};
+        for (uint8_t seat = 0; seat < playerCount; ++seat)
+            if (alive[seat])
+                ++count[identity[seat] - 1];
+        if (count[0] == 0)
+            winner = REBEL;
+        else if (count[2] == 0)
+            winner = LORD;
+    }
+}
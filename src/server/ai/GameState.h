@@ -0,0 +1,119 @@
+
+#ifndef KINGDOMCARD_GAMESTATE_H
+#define KINGDOMCARD_GAMESTATE_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "basic/Card.h"
+#include "basic/Player.h"
+#include "basic/Utility.h"
+
+namespace kc::ai {
+    size_t const MAX_MOVE_COUNT = 64;
+    uint8_t const MAX_PLAYS_PER_TURN = 8;       // 模拟中每回合最多主动出牌次数
+
+    /// @brief 轻量随机数发生器 (xorshift64*), 推演时比 std::mt19937 快得多
+    struct Rng {
+        uint64_t state;
+
+        explicit Rng(uint64_t seed) : state(seed ? seed : 0x9e3779b97f4a7c15ull) {}
+
+        uint64_t next() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545f4914f6cdd1dull;
+        }
+
+        uint32_t below(uint32_t n) { return static_cast<uint32_t>((next() >> 32) % n); }
+    };
+
+    /// @brief 一步主动出牌, END_TURN 表示结束回合
+    struct Move {
+        static uint8_t const END_TURN = 0xff;
+        uint8_t type;       // CardType
+        uint8_t target;     // 目标座位
+
+        [[nodiscard]] bool isEndTurn() const { return type == END_TURN; }
+
+        bool operator==(const Move &other) const { return type == other.type && target == other.target; }
+    };
+
+    struct MoveList {
+        std::array<Move, MAX_MOVE_COUNT> items;
+        size_t size = 0;
+
+        void push(Move move) { items[size++] = move; }
+    };
+
+    /// @brief 机器人可见的信息集: 自己的手牌, 其他玩家的公开状态
+    struct Observation {
+        uint8_t playerCount = 0;
+        uint8_t self = 0;                       // 自己的座位
+        uint8_t lordSeat = 0;
+        uint8_t playsThisTurn = 0;
+        uint8_t slashed = 0;
+        PlayerIdentity selfIdentity = UNKNOWN;
+        uint8_t drawPerTurn = DRAW_PER_TURN;
+        CardCounts cardCount = CARD_COUNT;      // 本局整副牌的构成
+        std::array<uint8_t, 4> identityCount{}; // 本局主公、忠臣、反贼、内奸的人数
+        std::array<uint8_t, MAX_PLAYER_NUM> hp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> maxHp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> alive{};
+        std::array<uint8_t, MAX_PLAYER_NUM> handSize{};
+        std::array<uint8_t, CARD_TYPE_COUNT> ownHand{};
+    };
+
+    /// @brief 紧凑且可平凡复制的完整游戏状态, 供 ISMCTS 确定化后推演
+    /// @details 手牌只记录每种牌的张数, 玩家属性按座位以 SoA 排列,
+    ///          牌堆是容量为 DECK_CARD_COUNT 的环形队列, 弃牌直接放回队尾
+    struct GameState {
+        uint8_t playerCount = 0;
+        uint8_t current = 0;                    // 当前回合座位
+        uint8_t lordSeat = 0;
+        uint8_t playsThisTurn = 0;
+        uint8_t slashed = 0;
+        uint8_t winner = UNKNOWN;               // 胜利阵营, UNKNOWN 表示未结束
+        uint8_t deckHead = 0;
+        uint8_t deckCount = 0;
+        uint8_t drawPerTurn = DRAW_PER_TURN;
+        std::array<uint8_t, MAX_PLAYER_NUM> hp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> maxHp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> alive{};
+        std::array<uint8_t, MAX_PLAYER_NUM> identity{};
+        std::array<uint8_t, MAX_PLAYER_NUM> handSize{};
+        std::array<std::array<uint8_t, CARD_TYPE_COUNT>, MAX_PLAYER_NUM> hand{};
+        std::array<uint8_t, DECK_CARD_COUNT> deck{};
+
+        [[nodiscard]] static GameState determinize(const Observation &obs, Rng &rng);
+
+        void generateMoves(MoveList &moves) const;
+
+        void apply(Move move, Rng &rng);
+
+        [[nodiscard]] bool isTerminal() const { return winner != UNKNOWN; }
+
+        [[nodiscard]] double reward(uint8_t seat) const;
+
+    private:
+        void draw(uint8_t seat, size_t count);
+
+        void discard(uint8_t seat, uint8_t type);
+
+        void discardRandom(uint8_t seat, Rng &rng, uint8_t to_seat = 0xff);
+
+        bool react(uint8_t seat, TurnType type);
+
+        void damage(uint8_t seat);
+
+        void endTurn(Rng &rng);
+
+        void checkWin();
+    };
+
+    static_assert(std::is_trivially_copyable_v<GameState>, "GameState 必须可平凡复制");
+    static_assert(sizeof(GameState) <= 256, "GameState 应保持在几百字节以内");
+}
+
+#endif //KINGDOMCARD_GAMESTATE_H
@@ -0,0 +1,138 @@
+
+#include "Ismcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <spdlog/spdlog.h>
+#include "basic/Shard.h"
+
+namespace kc::ai {
+    /// @brief 在时间预算内搜索, 返回根节点访问次数最多的动作
+    Move Ismcts::decide(const Observation &obs) const {
+        auto deadline = std::chrono::steady_clock::now() + config.budget;
+        size_t thread_num = std::max<size_t>(1, config.threads);
+        std::vector<Result> results(thread_num);
+        std::vector<std::thread> workers;
+        std::random_device rd;
+        for (size_t i = 1; i < thread_num; ++i) {
+            uint64_t seed = (uint64_t(rd()) << 32) | rd();
+            // 房间线程绑定在一个核心上, 搜索线程须解除继承的绑定才能真正并行
+            workers.emplace_back([&, i, seed] {
+                unpinCurrentThread();
+                results[i] = search(obs, seed, deadline);
+            });
+        }
+        results[0] = search(obs, (uint64_t(rd()) << 32) | rd(), deadline);
+        for (auto &worker : workers)
+            worker.join();
+
+        // 合并各棵树根节点的访问次数
+        std::vector<std::pair<Move, uint32_t>> merged;
+        size_t iterations = 0;
+        for (const auto &result : results) {
+            iterations += result.iterations;
+            for (const auto &[move, visits] : result.rootVisits) {
+                auto it = std::find_if(merged.begin(), merged.end(),
+                                       [&](const auto &m) { return m.first == move; });
+                if (it == merged.end())
+                    merged.emplace_back(move, visits);
+                else
+                    it->second += visits;
+            }
+        }
+        Move best {Move::END_TURN, obs.self};
+        uint32_t best_visits = 0;
+        for (const auto &[move, visits] : merged)
+            if (visits > best_visits) {
+                best = move;
+                best_visits = visits;
+            }
+        spdlog::debug("ISMCTS 迭代 {} 次, 选择 type: {} target: {} ({} 次访问)",
+                      iterations, best.type, best.target, best_visits);
+        return best;
+    }
+
+    /// @brief 单线程建树
+    Ismcts::Result Ismcts::search(const Observation &obs, uint64_t seed,
+                                  std::chrono::steady_clock::time_point deadline) const {
+        Rng rng(seed);
+        std::vector<Node> tree;
+        tree.reserve(4096);
+        tree.push_back(Node{{Move::END_TURN, obs.self}, obs.self, -1, {}});
+        MoveList moves;
+        Result result;
+        while (config.maxIterations == 0 || result.iterations < config.maxIterations) {
+            // 每 16 次迭代检查一次时间, 减少取时钟的开销
+            if ((result.iterations & 15) == 0 && std::chrono::steady_clock::now() >= deadline)
+                break;
+            ++result.iterations;
+            GameState state = GameState::determinize(obs, rng);
+            int32_t node = 0;
+
+            // 选择与扩展
+            while (!state.isTerminal()) {
+                state.generateMoves(moves);
+                int32_t untried = -1;
+                size_t untried_count = 0;
+                int32_t best = -1;
+                double best_score = -1;
+                for (size_t i = 0; i < moves.size; ++i) {
+                    int32_t child = -1;
+                    for (int32_t c : tree[node].children)
+                        if (tree[c].move == moves.items[i]) {
+                            child = c;
+                            break;
+                        }
+                    if (child < 0) {
+                        // 蓄水池抽样随机选择一个未尝试的动作
+                        if (rng.below(++untried_count) == 0)
+                            untried = static_cast<int32_t>(i);
+                        continue;
+                    }
+                    Node &n = tree[child];
+                    ++n.avail;
+                    double score = n.reward / n.visits
+                                   + config.exploration * std::sqrt(std::log(double(n.avail)) / n.visits);
+                    if (score > best_score) {
+                        best_score = score;
+                        best = child;
+                    }
+                }
+                if (untried >= 0) {
+                    Move move = moves.items[untried];
+                    tree.push_back(Node{move, state.current, node, {}});
+                    auto child = static_cast<int32_t>(tree.size() - 1);
+                    tree[node].children.push_back(child);
+                    tree[child].avail = 1;
+                    state.apply(move, rng);
+                    node = child;
+                    break;
+                }
+                state.apply(tree[best].move, rng);
+                node = best;
+            }
+
+            // 推演与回传
+            GameState final_state = rollout(state, rng);
+            for (int32_t n = node; n >= 0; n = tree[n].parent) {
+                ++tree[n].visits;
+                tree[n].reward += final_state.reward(tree[n].actor);
+            }
+        }
+        for (int32_t c : tree[0].children)
+            result.rootVisits.emplace_back(tree[c].move, tree[c].visits);
+        return result;
+    }
+
+    /// @brief 随机推演至终局或步数上限
+    GameState Ismcts::rollout(GameState state, Rng &rng) const {
+        MoveList moves;
+        for (size_t step = 0; step < config.maxRolloutSteps && !state.isTerminal(); ++step) {
+            state.generateMoves(moves);
+            state.apply(moves.items[rng.below(moves.size)], rng);
+        }
+        return state;
+    }
+}
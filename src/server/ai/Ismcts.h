@@ -0,0 +1,52 @@
+
+#ifndef KINGDOMCARD_ISMCTS_H
+#define KINGDOMCARD_ISMCTS_H
+
+#include <chrono>
+#include <vector>
+#include "ai/GameState.h"
+
+namespace kc::ai {
+    struct IsmctsConfig {
+        std::chrono::milliseconds budget {100};     // 每次决策的时间预算
+        size_t threads = 2;                         // 根并行的线程数, 每个线程独立建树
+        size_t maxIterations = 0;                   // 每个线程的迭代上限, 0 表示只受时间限制
+        size_t maxRolloutSteps = 400;               // 单次推演的最大步数
+        double exploration = 0.7;                   // UCB 探索系数
+    };
+
+    /// @brief 单观察者信息集蒙特卡洛树搜索 (SO-ISMCTS)
+    /// @details 每次迭代先对信息集确定化, 再在共享的树上按可用次数修正的 UCB 选择,
+    ///          随机推演至终局后按每个节点行动者的阵营回传收益
+    class Ismcts {
+    private:
+        struct Node {
+            Move move;
+            uint8_t actor;                  // 做出该动作的座位
+            int32_t parent;
+            std::vector<int32_t> children;
+            uint32_t visits = 0;
+            uint32_t avail = 0;
+            double reward = 0;
+        };
+
+        struct Result {
+            std::vector<std::pair<Move, uint32_t>> rootVisits;
+            size_t iterations = 0;
+        };
+
+        IsmctsConfig config;
+
+        [[nodiscard]] Result search(const Observation &obs, uint64_t seed,
+                                    std::chrono::steady_clock::time_point deadline) const;
+
+        [[nodiscard]] GameState rollout(GameState state, Rng &rng) const;
+
+    public:
+        explicit Ismcts(IsmctsConfig config = {}) : config(config) {}
+
+        [[nodiscard]] Move decide(const Observation &obs) const;
+    };
+}
+
+#endif //KINGDOMCARD_ISMCTS_H
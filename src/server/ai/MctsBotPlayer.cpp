@@ -0,0 +1,44 @@
+
+#include "MctsBotPlayer.h"
+
+namespace kc {
+    /// @brief 由可见信息构造观察, 搜索后把座位与牌型映射回具体的牌与玩家
+    std::optional<CardAction> MctsBotPlayer::decideTurn(const PlayerTable &table, size_t seat, size_t lord_id) {
+        ai::Observation obs;
+        obs.playerCount = table.size;
+        obs.self = seat;
+        obs.selfIdentity = table.identity[seat];
+        obs.playsThisTurn = playsThisTurn;
+        obs.slashed = slashedThisTurn;
+        obs.drawPerTurn = table.drawPerTurn;
+        // 牌组与身份的构成是公开的规则, 只取计数
+        obs.cardCount.fill(0);
+        for (size_t idx = 0; idx < table.deckCardCount(); ++idx)
+            ++obs.cardCount[table.cardType[idx]];
+        for (uint8_t other = 0; other < table.size; ++other) {
+            if (table.identity[other] != UNKNOWN)
+                ++obs.identityCount[table.identity[other] - 1];
+            if (table.id[other] == lord_id)
+                obs.lordSeat = other;
+            obs.hp[other] = table.hp[other];
+            obs.maxHp[other] = table.maxHp[other];
+            obs.alive[other] = table.alive[other];
+            obs.handSize[other] = table.cardCount[other];
+        }
+        for (uint8_t t = 0; t < CARD_TYPE_COUNT; ++t)
+            obs.ownHand[t] = table.typeCount[seat][t];
+
+        ai::Move move = search.decide(obs);
+        if (move.isEndTurn())
+            return std::nullopt;
+        for (const auto &card : getCards()) {
+            if (card->type != move.type)
+                continue;
+            ++playsThisTurn;
+            if (card->type == CardType::SLASH)
+                slashedThisTurn = true;
+            return CardAction{card->id, card->type, id, table.id[move.target]};
+        }
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,22 @@
+
+#ifndef KINGDOMCARD_MCTSBOTPLAYER_H
+#define KINGDOMCARD_MCTSBOTPLAYER_H
+
+#include "basic/BotPlayer.h"
+#include "ai/Ismcts.h"
+
+namespace kc {
+    /// @brief 使用 ISMCTS 决定主动出牌的机器人, 反应沿用 BotPlayer 的规则
+    class MctsBotPlayer : public BotPlayer {
+    private:
+        ai::Ismcts search;
+
+    public:
+        MctsBotPlayer(uint32_t id, ai::IsmctsConfig config) : BotPlayer(id), search(config) {}
+
+        [[nodiscard]] std::optional<CardAction> decideTurn(const PlayerTable &table, size_t seat,
+                                                           size_t lord_id) override;
+    };
+}
+
+#endif //KINGDOMCARD_MCTSBOTPLAYER_H
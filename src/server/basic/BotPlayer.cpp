@@ -0,0 +1,102 @@
+
+#include "BotPlayer.h"
+
+namespace kc {
+    /// @brief 选择攻击目标: 反贼优先主公, 其他身份选择体力最低的非主公玩家
+    std::optional<size_t> BotPlayer::chooseTarget(const PlayerTable &table, size_t seat, size_t lord_id) const {
+        size_t best = NO_SEAT;
+        for (size_t other = 0; other < table.size; ++other) {
+            if (other == seat || !table.alive[other])
+                continue;
+            if (table.identity[seat] == REBEL && table.id[other] == lord_id)
+                return table.id[other];
+            if (table.identity[seat] != REBEL && table.id[other] == lord_id)
+                continue;
+            if (best == NO_SEAT || table.hp[other] < table.hp[best])
+                best = other;
+        }
+        if (best == NO_SEAT)
+            return std::nullopt;
+        return table.id[best];
+    }
+
+    /// @brief 主动出牌阶段的决策
+    /// @return 要打出的牌, 为空表示结束回合
+    /// @param seat 自己的座位
+    std::optional<CardAction> BotPlayer::decideTurn(const PlayerTable &table, size_t seat, size_t lord_id) {
+        if (playsThisTurn >= BOT_MAX_PLAYS_PER_TURN)
+            return std::nullopt;
+        const auto &available = TurnCardsAvailable.at(TurnType::ACTIVE);
+        std::optional<size_t> target = chooseTarget(table, seat, lord_id);
+        for (const auto &card : getCards()) {
+            if (available.find(card->type) == available.end())
+                continue;
+            switch (card->type) {
+                case CardType::SLASH:
+                    if (slashedThisTurn || !target.has_value())
+                        continue;
+                    slashedThisTurn = true;
+                    [[fallthrough]];
+                case CardType::DISMANTLE:
+                case CardType::STEAL:
+                case CardType::DUEL:
+                    if (!target.has_value())
+                        continue;
+                    ++playsThisTurn;
+                    return CardAction{card->id, card->type, id, target.value()};
+                case CardType::PEACH:
+                    if (table.hp[seat] >= table.maxHp[seat])
+                        continue;
+                    [[fallthrough]];
+                default:
+                    ++playsThisTurn;
+                    return CardAction{card->id, card->type, id, id};
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// @brief 结束回合时的弃牌决策, 保留能用于反应的牌
+    /// @param health 当前体力, 即需要保留的手牌数
+    DiscardAction BotPlayer::decideDiscard(size_t health) {
+        playsThisTurn = 0;
+        slashedThisTurn = false;
+        DiscardAction discard{id};
+        if (getCardCount() <= health)
+            return discard;
+        size_t count = getCardCount() - health;
+        // 先弃掉主动牌, 再弃掉反应牌
+        for (int pass = 0; pass < 2 && discard.card_ids.size() < count; ++pass)
+            for (const auto &card : getCards()) {
+                if (discard.card_ids.size() >= count)
+                    break;
+                bool reactive = card->type == CardType::DODGE || card->type == CardType::UNRELENTING
+                                || card->type == CardType::PEACH;
+                if (reactive == (pass == 1))
+                    discard.card_ids.push_back(card->id);
+            }
+        return discard;
+    }
+
+    /// @brief 反应决策
+    /// @param type 反应类型
+    /// @param is_subject 自己是否为被指定的目标 (濒死时为濒死者)
+    /// @return 要打出的牌, 为空表示跳过
+    std::optional<CardAction> BotPlayer::decideReact(TurnType type, bool is_subject) const {
+        // 无懈可击和桃只留给自己
+        if ((type == TurnType::PASSIVE || type == TurnType::DYING) && !is_subject)
+            return std::nullopt;
+        const auto &available = TurnCardsAvailable.at(type);
+        const Card *chosen = nullptr;
+        for (const auto &card : getCards()) {
+            if (available.find(card->type) == available.end())
+                continue;
+            // 能用杀/闪应对时保留无懈可击
+            if (chosen == nullptr || chosen->type == CardType::UNRELENTING)
+                chosen = card.get();
+        }
+        if (chosen == nullptr)
+            return std::nullopt;
+        return CardAction{chosen->id, chosen->type, id, id};
+    }
+}
@@ -0,0 +1,39 @@
+
+#ifndef KINGDOMCARD_BOTPLAYER_H
+#define KINGDOMCARD_BOTPLAYER_H
+
+#include <optional>
+#include <set>
+#include <vector>
+#include "basic/Player.h"
+#include "basic/GameController.h"
+
+namespace kc {
+    size_t const BOT_MAX_PLAYS_PER_TURN = 4;   // 机器人每回合最多主动出牌次数
+
+    /// @brief 服务器内置的机器人玩家
+    /// @details 与玩家共享同一套状态与手牌接口, 但没有套接字:
+    ///          发给它的消息直接丢弃, 出牌与反应由 GameController 同步调用决策函数得到
+    class BotPlayer : public Player {
+    protected:
+        size_t playsThisTurn = 0;
+        bool slashedThisTurn = false;
+
+    private:
+        [[nodiscard]] std::optional<size_t> chooseTarget(const PlayerTable &table, size_t seat, size_t lord_id) const;
+
+    public:
+        explicit BotPlayer(uint32_t id) : Player(id, zmq::socket_t()) {}
+
+        [[nodiscard]] bool isBot() const override { return true; }
+
+        [[nodiscard]] virtual std::optional<CardAction> decideTurn(const PlayerTable &table, size_t seat,
+                                                                   size_t lord_id);
+
+        [[nodiscard]] DiscardAction decideDiscard(size_t health);
+
+        [[nodiscard]] std::optional<CardAction> decideReact(TurnType type, bool is_subject) const;
+    };
+}
+
+#endif //KINGDOMCARD_BOTPLAYER_H
@@ -2,5 +2,24 @@
 #include "Card.h"
 
 namespace kc {
-    uint16_t Card::idCounter = 0;
+    std::atomic<uint16_t> Card::idCounter = 0;
+
+    /// @brief 生成一副完整的牌, 按牌型排列
+    /// @details 无论牌组大小, 整副牌一次性占用 DECK_CARD_COUNT 个连续的 id (按 2^16 回绕),
+    ///          对局可以用 id 与首张牌的差作为下标
+    /// @param counts 每种牌的张数, 总数不超过 DECK_CARD_COUNT
+    std::vector<CardPtr> Card::generateDeck(const CardCounts &counts) {
+        return generateDeck(idCounter.fetch_add(DECK_CARD_COUNT), counts);
+    }
+
+    /// @brief 以指定的首张牌 id 生成一副完整的牌, 用于从快照恢复对局
+    std::vector<CardPtr> Card::generateDeck(uint16_t first_id, const CardCounts &counts) {
+        uint16_t id = first_id;
+        std::vector<CardPtr> deck;
+        deck.reserve(DECK_CARD_COUNT);
+        for (size_t tp = 0; tp < CARD_TYPE_COUNT; ++tp)
+            for (size_t num = 0; num < counts[tp]; ++num)
+                deck.emplace_back(new Card(id++, static_cast<CardType>(tp)));
+        return deck;
+    }
 }
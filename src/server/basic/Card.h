@@ -2,15 +2,20 @@
 #ifndef KINGDOMCARD_CARD_H
 #define KINGDOMCARD_CARD_H
 
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace kc {
     size_t const CARD_TYPE_COUNT = 12;
-    size_t const CARD_COUNT[] = { 6, 6, 6,
-                                  4, 4, 4, 4, 4, 4, 4, 4,
-                                  6};
+    typedef std::array<uint8_t, CARD_TYPE_COUNT> CardCounts;   // 按 CardType 排列的每种牌张数
+    CardCounts const CARD_COUNT = { 6, 6, 6,
+                                    4, 4, 4, 4, 4, 4, 4, 4,
+                                    6};     // 默认牌组, 房间规则可以另行配置
+    size_t const DECK_CARD_COUNT = 56;      // 整副牌张数的上限, 等于默认牌组的总数, 也是手牌数的上限
     std::string const CardName[] = { "杀", "闪", "桃",
                                      "过河拆桥", "顺手牵羊", "决斗", "万箭齐发", "南蛮入侵", "无中生有", "五谷丰登", "桃园结义",
                                      "无懈可击" };
@@ -38,7 +43,7 @@ namespace kc {
     private:
         Card(uint16_t id, CardType type) : id(id), type(type) {}
 
-        static uint16_t idCounter;
+        static std::atomic<uint16_t> idCounter;
     public:
         Card(Card const &) = delete;
 
@@ -48,6 +53,10 @@ namespace kc {
         CardPtr static generate(CardType type) {
             return std::unique_ptr<Card>(new Card(idCounter++, type));
         }
+
+        static std::vector<CardPtr> generateDeck(const CardCounts &counts = CARD_COUNT);
+
+        static std::vector<CardPtr> generateDeck(uint16_t first_id, const CardCounts &counts);
     };
 }
 
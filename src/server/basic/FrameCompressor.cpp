@@ -0,0 +1,85 @@
+#include "FrameCompressor.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+#ifdef KC_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace kc {
+    FrameCompressor::~FrameCompressor() {
+#ifdef KC_WITH_ZSTD
+        ZSTD_freeCDict(static_cast<ZSTD_CDict *>(cdict));
+#endif
+    }
+
+    FrameCompressor &FrameCompressor::instance() {
+        static FrameCompressor compressor;
+        return compressor;
+    }
+
+    /// @brief 加载 zstd --train 生成的字典, 须在房间开始之前调用
+    /// @throw std::runtime_error 文件无法读取、不是 zstd 字典, 或未以 KC_WITH_ZSTD 编译
+    void FrameCompressor::loadDictionary(const std::string &path) {
+#ifdef KC_WITH_ZSTD
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("无法打开 zstd 字典 " + path);
+        std::stringstream content;
+        content << file.rdbuf();
+        std::string loaded = content.str();
+        uint32_t id = ZSTD_getDictID_fromDict(loaded.data(), loaded.size());
+        if (id == 0)
+            throw std::runtime_error(path + " 不是 zstd 字典");
+        ZSTD_CDict *created = ZSTD_createCDict(loaded.data(), loaded.size(), COMPRESS_LEVEL);
+        if (created == nullptr)
+            throw std::runtime_error("无法加载 zstd 字典 " + path);
+        ZSTD_freeCDict(static_cast<ZSTD_CDict *>(cdict));
+        cdict = created;
+        dictId = id;
+        spdlog::info("已加载 zstd 字典 {}, id: {}", path, dictId);
+#else
+        throw std::runtime_error("未以 KC_WITH_ZSTD 编译, 忽略 zstd 字典 " + path);
+#endif
+    }
+
+    /// @brief 客户端能否解压本服务器压缩的合并帧
+    /// @param zstd 客户端支持 zstd
+    /// @param dict_id 客户端加载的字典 id, 须与服务器一致
+    bool FrameCompressor::accepts(bool zstd, uint32_t dict_id) const {
+#ifdef KC_WITH_ZSTD
+        return zstd && dict_id == dictId;
+#else
+        (void) zstd;
+        (void) dict_id;
+        return false;
+#endif
+    }
+
+    /// @brief 压缩合并帧的消息区
+    /// @return 压缩后确实更短时为 true, 结果写入 output
+    bool FrameCompressor::compress(const std::string &input, std::string &output) const {
+#ifdef KC_WITH_ZSTD
+        if (input.size() < COMPRESS_THRESHOLD)
+            return false;
+        thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx *)> cctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+        output.resize(ZSTD_compressBound(input.size()));
+        size_t size = cdict != nullptr
+                      ? ZSTD_compress_usingCDict(cctx.get(), output.data(), output.size(), input.data(), input.size(),
+                                                 static_cast<const ZSTD_CDict *>(cdict))
+                      : ZSTD_compressCCtx(cctx.get(), output.data(), output.size(), input.data(), input.size(),
+                                          COMPRESS_LEVEL);
+        if (ZSTD_isError(size) || size >= input.size())
+            return false;
+        output.resize(size);
+        return true;
+#else
+        (void) input;
+        (void) output;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,37 @@
+
+#ifndef KINGDOMCARD_FRAMECOMPRESSOR_H
+#define KINGDOMCARD_FRAMECOMPRESSOR_H
+
+#include <cstdint>
+#include <string>
+
+namespace kc {
+    size_t const COMPRESS_THRESHOLD = 512;  // 消息区不小于此长度的合并帧才尝试压缩
+    int const COMPRESS_LEVEL = 3;
+
+    /// @brief 压缩较大的合并帧, 所有房间线程共用
+    /// @details 字典只在启动时加载一次, 之后只读, 可以在多个线程中同时使用;
+    ///          每个线程各自持有压缩上下文. 未以 KC_WITH_ZSTD 编译时不接受任何压缩请求
+    class FrameCompressor {
+    private:
+        uint32_t dictId = 0;
+        void *cdict = nullptr;          // ZSTD_CDict, 不使用字典时为空
+
+        FrameCompressor() = default;
+
+    public:
+        FrameCompressor(const FrameCompressor &) = delete;
+
+        ~FrameCompressor();
+
+        static FrameCompressor &instance();
+
+        void loadDictionary(const std::string &path);
+
+        [[nodiscard]] bool accepts(bool zstd, uint32_t dict_id) const;
+
+        bool compress(const std::string &input, std::string &output) const;
+    };
+}
+
+#endif //KINGDOMCARD_FRAMECOMPRESSOR_H
@@ -2,21 +2,24 @@
 #ifndef KINGDOMCARD_GAMECONTROLLER_H
 #define KINGDOMCARD_GAMECONTROLLER_H
 
-#include <any>
+#include <atomic>
 #include <chrono>
 #include <vector>
 #include <memory>
-#include <set>
+#include <variant>
 #include "basic/Player.h"
+#include "basic/PlayerTable.h"
+#include "basic/ServerConfig.h"
+#include "basic/StaticVector.h"
+#include "basic/SnapshotWriter.h"
+#include "basic/SpectatorFeed.h"
+#include "basic/TimerWheel.h"
 #include "basic/Card.h"
 #include "basic/Utility.h"
 #include "basic_message.pb.h"
 
 namespace kc {
 
-    const std::chrono::microseconds TURN_TIME_LIMIT = std::chrono::seconds(30);
-    const std::chrono::microseconds REACT_TIME_LIMIT = std::chrono::seconds(5);
-
     class CardAction {
     public:
         CardAction(size_t card_id, CardType type, size_t source_id, size_t target_id) :
@@ -31,29 +34,72 @@ namespace kc {
 
     class DiscardAction {
     public:
-        DiscardAction(size_t player_id, std::set<size_t> card_ids) :
-                player_id(player_id), card_ids(std::move(card_ids)) {}
+        explicit DiscardAction(size_t player_id) : player_id(player_id) {}
         size_t const player_id;
-        std::set<size_t> const card_ids;
+        StaticVector<size_t, DECK_CARD_COUNT> card_ids;
+    };
+
+    /// @brief 等待出牌超时
+    struct Timeout {};
+
+    /// @brief 对局的公开进度, 游戏线程在回合边界以 relaxed 原子写入, 管理线程不加锁读取
+    struct MatchStatus {
+        std::atomic<uint32_t> turn{0};
+        std::atomic<uint32_t> currentPlayer{0};
+        std::atomic<uint8_t> aliveCount{0};
+        std::atomic<bool> abortRequested{false};    // 由管理线程置位, 游戏线程在下一个回合边界解散对局
     };
 
+    /// @brief waitForCard 的结果
+    using TurnResult = std::variant<CardAction, DiscardAction, Timeout>;
+
+    /// @brief 一次等待中监听的玩家套接字, 末尾另留一格给唤醒器
+    typedef StaticVector<zmq::pollitem_t, MAX_PLAYER_NUM + 1> PollItems;
+
     class GameController {
+        friend class GameControllerProbe;   // 供 kc_bench 访问内部状态
     private:
         bool isStarted = false;
         size_t currIdx = 0;
         size_t playingId = 0;
         size_t lordId = -1;
-        std::vector<PlayerPtr> &players;
+        std::vector<PlayerPtr> &players;    // 冷数据: 套接字与手牌实体, 下标即座位
+        PlayerTable table;                  // 热数据: 体力、身份、存活与手牌计数
         std::vector<CardPtr> cards;
         util::Timer turn_timer;
+        std::shared_ptr<Waker> waker = std::make_shared<Waker>();   // 出牌与反应时限到期时由时间轮唤醒
+        RoomRules rules;                    // 时限、牌组、身份分配与摸牌数
+        SnapshotWriter *snapshots = nullptr;  // 为空时不保存快照
+        SpectatorFeed *spectators = nullptr;  // 为空时不发布观战事件
+        MatchStatus *status = nullptr;        // 为空时不公开进度
+        uint64_t matchId = 0;
+        uint32_t turnCount = 0;
 
         void init();
 
+        void run();
+
+        void restore(const MatchSnapshot &snapshot);
+
+        [[nodiscard]] MatchSnapshot snapshot() const;
+
+        void saveSnapshot();
+
+        void publishStatus();
+
         void startCommand();
 
         void broadcast(CommandType commandType, const std::string &msg);
 
-        [[nodiscard]] std::vector<size_t> getPlayerList(bool exclude_current = false) const;
+        void broadcast(CommandType commandType, const google::protobuf::Message &msg);
+
+        void holdOutput();
+
+        void flushOutput();
+
+        void releaseOutput();
+
+        [[nodiscard]] IdSpan getPlayerList() const { return table.alivePlayers(); }
 
         size_t nextPlayerIdx();
 
@@ -63,15 +109,38 @@ namespace kc {
 
         [[nodiscard]] CardPtr drawCard();
 
+        void drawCards(std::vector<CardPtr> &card_list, size_t num);
+
         void newTurn();
 
-        [[nodiscard]] Player& findPlayerById(size_t id);
+        [[nodiscard]] size_t seatOf(size_t id) const;
 
-        [[nodiscard]] std::any waitForCard(const std::vector<size_t> &target);
+        void giveCards(size_t seat, std::vector<CardPtr> &&card_list);
+
+        [[nodiscard]] CardPtr takeCardByNum(size_t seat, size_t num);
+
+        void discardExcess(size_t seat);
+
+        [[nodiscard]] int pollUntil(PollItems &items, std::chrono::steady_clock::time_point deadline);
+
+        void sendYourTurn(Player &player, TurnType type, std::chrono::steady_clock::time_point deadline);
+
+        [[nodiscard]] TurnResult waitForCard(IdSpan target, std::chrono::steady_clock::time_point deadline);
 
         void bcCard(const CardAction& action);
 
-        [[nodiscard]] std::optional<CardAction> waitForReact(const std::vector<size_t> &target, TurnType type);
+        [[nodiscard]] std::optional<CardAction> waitForReact(IdSpan target, TurnType type,
+                                                             size_t subject_id = -1);
+
+        void rejectPlay(const CardAction& action, PlayError err);
+
+        [[nodiscard]] PlayError validatePlay(const CardAction& action) const;
+
+        [[nodiscard]] PlayError checkTarget(const CardAction& action) const;
+
+        [[nodiscard]] PlayError checkOwnership(size_t player_id, size_t card_id, CardType type) const;
+
+        [[nodiscard]] PlayError discardCards(const DiscardAction& action);
 
         void dealWithCard(const CardAction& action);
 
@@ -86,7 +155,17 @@ namespace kc {
     public:
         explicit GameController(std::vector<PlayerPtr> &players) : players(players) {}
 
+        void setSnapshotWriter(SnapshotWriter *writer, uint64_t match_id);
+
+        void setSpectatorFeed(SpectatorFeed *feed);
+
+        void setRules(const RoomRules &room_rules);
+
+        void setMatchStatus(MatchStatus *match_status);
+
         void start();
+
+        void resume(const MatchSnapshot &snapshot);
     };
 }
 
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <spdlog/spdlog.h>
 #include "basic/Utility.h"
+#include "basic/Metrics.h"
 #include "basic_message.pb.h"
 #include "basic_object.pb.h"
 #include "command.pb.h"
@@ -13,15 +14,73 @@
 namespace kc {
     /// @brief 开始游戏
     void GameController::start() {
+        holdOutput();
         init();
+        run();
+    }
+
+    /// @brief 从快照恢复对局, 从快照中记录的座位开始下一个回合
+    /// @param snapshot 已通过 isValid 检查的快照, players 中须包含快照里的所有玩家
+    void GameController::resume(const MatchSnapshot &snapshot) {
+        holdOutput();
+        restore(snapshot);
+        run();
+    }
+
+    /// @brief 设置快照的写入者, 每个回合开始前提交一份快照
+    /// @param writer 快照写入者, 为空时不保存
+    /// @param match_id 对局 id, 用作快照文件名
+    void GameController::setSnapshotWriter(SnapshotWriter *writer, uint64_t match_id) {
+        snapshots = writer;
+        matchId = match_id;
+    }
+
+    /// @brief 设置观战事件流, 公开事件在广播给玩家的同时发布一份
+    void GameController::setSpectatorFeed(SpectatorFeed *feed) {
+        spectators = feed;
+    }
+
+    /// @brief 设置本局的规则, 须在 start 或 resume 之前调用
+    void GameController::setRules(const RoomRules &room_rules) {
+        rules = room_rules;
+    }
+
+    /// @brief 设置对局进度的公开位置, 也用于接收解散请求
+    void GameController::setMatchStatus(MatchStatus *match_status) {
+        status = match_status;
+    }
+
+    /// @brief 主循环
+    void GameController::run() {
         isStarted = true;
-        // 主循环
         while (isStarted) {
+            publishStatus();
+            if (status != nullptr && status->abortRequested.load(std::memory_order_relaxed)) {
+                spdlog::warn("对局 {} 被解散", matchId);
+                broadcast(CommandType::KICK, "");
+                break;
+            }
+            saveSnapshot();
             newTurn();
             nextPlayerIdx();
             if (checkWin())
                 isStarted = false;
+            // 全是机器人的回合里没有等待, 在回合边界发出, 观看的玩家不至于等到下一次等待
+            flushOutput();
         }
+        releaseOutput();
+        publishStatus();
+        if (snapshots != nullptr)
+            snapshots->discard(matchId);
+    }
+
+    /// @brief 在回合边界公开对局进度
+    void GameController::publishStatus() {
+        if (status == nullptr)
+            return;
+        status->turn.store(turnCount, std::memory_order_relaxed);
+        status->currentPlayer.store(table.id[currIdx], std::memory_order_relaxed);
+        status->aliveCount.store(table.aliveCount, std::memory_order_relaxed);
     }
 
     /// @brief 初始化游戏
@@ -29,42 +88,44 @@ namespace kc {
         // 初始化角色
         {
             size_t player_num = players.size();
-            if (player_num < 4 || player_num > 10) {
+            if (player_num < MIN_PLAYER_NUM || player_num > MAX_PLAYER_NUM) {
                 throw std::invalid_argument("玩家数量不合法");
             }
-            // 随机排列角色
-            std::shuffle(players.begin(), players.end(), std::default_random_engine(std::random_device()()));
-            // 选取首位为主公
-            lordId = players[0]->id;
-            // 为角色分配身份
-            size_t idx = 0;
-            for (int idt = 0; idt < 4; ++idt)
-                for (int num = 0; num < ID_COUNT[player_num - 4][idt]; ++num)
-                    players[idx++]->setIdentity(static_cast<PlayerIdentity>(idt + 1));
-            // 按照 id 排序
+            // 按照 id 排序, 下标即座位
             std::sort(players.begin(), players.end(), [](const PlayerPtr &a, const PlayerPtr &b) {
                 return a->id < b->id;
             });
+            table.reset(players);
+            // 随机排列身份并按座位分配
+            std::vector<PlayerIdentity> identities;
+            for (int idt = 0; idt < 4; ++idt)
+                for (int num = 0; num < rules.identityCount[player_num - MIN_PLAYER_NUM][idt]; ++num)
+                    identities.emplace_back(static_cast<PlayerIdentity>(idt + 1));
+            std::shuffle(identities.begin(), identities.end(), std::default_random_engine(std::random_device()()));
+            for (size_t seat = 0; seat < table.size; ++seat) {
+                table.identity[seat] = identities[seat];
+                if (identities[seat] == PlayerIdentity::LORD)
+                    lordId = table.id[seat];
+            }
         }
         startCommand();
         // 初始化牌组
         {
-            for (int tp = 0; tp < CARD_TYPE_COUNT; ++tp)
-                for (int num = 0; num < CARD_COUNT[tp]; ++num)
-                    cards.emplace_back(Card::generate(static_cast<CardType>(tp)));
+            cards = Card::generateDeck(rules.cardCount);
+            table.resetDeck(cards);
+            table.drawPerTurn = rules.drawPerTurn;
             // 洗牌
             std::shuffle(cards.begin(), cards.end(), std::default_random_engine(std::random_device()()));
             for (const auto &card : cards)
                 spdlog::debug("id: {} type: {}", card->id, CardName[card->type]);
             // 分配给角色
-            for (const auto &player : players) {
+            for (size_t seat = 0; seat < table.size; ++seat) {
                 std::vector<CardPtr> card_to_add;
-                for (int i = 0; i < 4; ++i)
-                    card_to_add.emplace_back(drawCard());
-                spdlog::info("玩家 {} 初始牌组:", player->id);
+                drawCards(card_to_add, rules.initialHand);
+                spdlog::info("玩家 {} 初始牌组:", table.id[seat]);
                 for (const auto &card : card_to_add)
                     spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
-                player->newCardList(std::move(card_to_add));
+                giveCards(seat, std::move(card_to_add));
             }
         }
         {
@@ -73,7 +134,8 @@ namespace kc {
             spdlog::info("主公: {}", lordId);
             spdlog::info("角色分配: ");
             for (const auto &player : players) {
-                spdlog::info("玩家 {} 身份: {}", player->id, PlayerIdentityName[player->getIdentity()]);
+                spdlog::info("玩家 {} 身份: {}", player->id,
+                             PlayerIdentityName[table.identity[table.seatOf(player->id)]]);
                 spdlog::debug("玩家 {} 手牌: ", player->id);
                 for (const auto &card : player->getCards())
                     spdlog::debug("id: {} type: {}", card->id, CardName[card->type]);
@@ -81,67 +143,130 @@ namespace kc {
         }
     }
 
+    /// @brief 按快照恢复座位、身份、体力、牌堆与手牌, 并重新通知所有玩家
+    void GameController::restore(const MatchSnapshot &snapshot) {
+        std::sort(players.begin(), players.end(), [](const PlayerPtr &a, const PlayerPtr &b) {
+            return a->id < b->id;
+        });
+        if (players.size() != snapshot.playerCount)
+            throw std::invalid_argument("快照的玩家数量不匹配");
+        for (size_t seat = 0; seat < snapshot.playerCount; ++seat)
+            if (players[seat]->id != snapshot.id[seat])
+                throw std::invalid_argument("快照的玩家 id 不匹配");
+        table.reset(players);
+        for (size_t seat = 0; seat < table.size; ++seat) {
+            table.hp[seat] = snapshot.hp[seat];
+            table.maxHp[seat] = snapshot.maxHp[seat];
+            table.identity[seat] = static_cast<PlayerIdentity>(snapshot.identity[seat]);
+            if (!snapshot.alive[seat])
+                table.kill(seat);
+        }
+        lordId = snapshot.lordId;
+        matchId = snapshot.matchId;
+        turnCount = snapshot.turn;
+        currIdx = snapshot.currSeat;
+        playingId = table.id[currIdx];
+        startCommand();
+        // 牌组与摸牌数以快照为准, 牌的类型由首张牌的 id 推出, 与 init 中生成的整副牌一致
+        rules.cardCount = snapshot.cardCount;
+        rules.drawPerTurn = snapshot.drawPerTurn;
+        std::vector<CardPtr> deck = Card::generateDeck(snapshot.cardIdBase, rules.cardCount);
+        table.resetDeck(deck);
+        table.drawPerTurn = rules.drawPerTurn;
+        cards.clear();
+        for (size_t i = 0; i < snapshot.deckCount; ++i)
+            cards.emplace_back(std::move(deck[snapshot.deck[i]]));
+        for (size_t seat = 0; seat < table.size; ++seat) {
+            std::vector<CardPtr> hand;
+            for (size_t idx = 0; idx < deck.size(); ++idx)
+                if (snapshot.cardOwner[idx] == seat)
+                    hand.emplace_back(std::move(deck[idx]));
+            giveCards(seat, std::move(hand));
+        }
+        spdlog::info("对局 {} 已从第 {} 回合的快照恢复, 下一个回合: 玩家 {}", matchId, turnCount, playingId);
+    }
+
+    /// @brief 生成当前回合边界的快照, 只做定长拷贝
+    MatchSnapshot GameController::snapshot() const {
+        MatchSnapshot snapshot{};
+        snapshot.playerCount = table.size;
+        snapshot.matchId = matchId;
+        snapshot.turn = turnCount;
+        snapshot.currSeat = currIdx;
+        snapshot.lordId = lordId;
+        snapshot.cardIdBase = table.firstCardId();
+        snapshot.deckCount = cards.size();
+        snapshot.cardCount = rules.cardCount;
+        snapshot.drawPerTurn = rules.drawPerTurn;
+        for (size_t seat = 0; seat < table.size; ++seat) {
+            snapshot.id[seat] = table.id[seat];
+            snapshot.hp[seat] = table.hp[seat];
+            snapshot.maxHp[seat] = table.maxHp[seat];
+            snapshot.alive[seat] = table.alive[seat];
+            snapshot.identity[seat] = table.identity[seat];
+            snapshot.isBot[seat] = players[seat]->isBot();
+            snapshot.sessionToken[seat] = players[seat]->sessionToken;
+        }
+        for (size_t i = 0; i < cards.size(); ++i)
+            snapshot.deck[i] = table.cardIndex(cards[i]->id);
+        snapshot.cardOwner = table.cardOwner;
+        seal(snapshot);
+        return snapshot;
+    }
+
+    /// @brief 在回合边界提交快照, 写盘由 SnapshotWriter 的线程完成
+    void GameController::saveSnapshot() {
+        if (snapshots == nullptr)
+            return;
+        metrics::ScopedTimer timer(metrics::Histogram::SNAPSHOT);
+        snapshots->submit(snapshot());
+    }
+
     /// @brief 新的回合
     void GameController::newTurn() {
+        ++turnCount;
         turn_timer.reset();
         // 发牌
         std::vector<CardPtr> card_to_add;
-        card_to_add.emplace_back(drawCard());
-        card_to_add.emplace_back(drawCard());
+        drawCards(card_to_add, rules.drawPerTurn);
         spdlog::info("玩家 {} 回合开始, 发牌", players[currIdx]->id);
         for (const auto &card : card_to_add)
             spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
-        players[currIdx]->newCardList(std::move(card_to_add));
+        giveCards(currIdx, std::move(card_to_add));
 
         bcStatus();
 
         bool isContinue = true;
         while (isContinue) {
-            // 发送回合进行消息
-            YourTurn cmd_yt;
-            cmd_yt.set_remainingtime((TURN_TIME_LIMIT - turn_timer.getTime()).count() / 1000.0f);
-            util::sendCommand(players[currIdx], CommandType::YOUR_TURN, cmd_yt.SerializeAsString());
+            // 发送回合进行消息, 截止时刻同时用于服务器判定超时
+            auto deadline = std::chrono::steady_clock::now() + (rules.turnTimeLimit - turn_timer.getTime());
+            sendYourTurn(*players[currIdx], TurnType::ACTIVE, deadline);
             turn_timer.start();     // 开始计时
 
             spdlog::info("玩家 {} 回合进行中", players[currIdx]->id);
-            auto rslt = waitForCard({players[currIdx]->id});
-            if (rslt.type() == typeid(CardAction)) {
+            TurnResult rslt = waitForCard(players[currIdx]->id, deadline);
+            if (auto *action = std::get_if<CardAction>(&rslt)) {
                 spdlog::info("玩家 {} 出牌", players[currIdx]->id);
-                auto action = std::any_cast<CardAction>(rslt);
                 turn_timer.pause();
-                // 处理出牌
-                try {
-                    dealWithCard(action);
-                } catch (std::exception &e) {
-                    spdlog::error("玩家 {} 出牌异常: {}", players[currIdx]->id, e.what());
-                    continue;
-                }
+                // 处理出牌, waitForCard 已校验过
+                dealWithCard(*action);
                 isContinue = !checkWin();
             }
-            else if (rslt.type() == typeid(DiscardAction)) {
-                auto action = std::any_cast<DiscardAction>(rslt);
+            else if (auto *discard = std::get_if<DiscardAction>(&rslt)) {
                 spdlog::info("玩家 {} 弃牌", players[currIdx]->id);
                 // 验证弃牌
-                try {
-                    for (const auto &card_id : action.card_ids)
-                        removeCard(players[currIdx]->id, card_id);
-                    if (players[currIdx]->getCards().size() > players[currIdx]->getHealth())
-                        throw std::invalid_argument("弃牌数量过少");
-                } catch (std::exception &e) {
-                    spdlog::error("玩家 {} 弃牌异常: {}", players[currIdx]->id, e.what());
+                PlayError err = discardCards(*discard);
+                if (err != PlayError::NONE) {
+                    spdlog::error("玩家 {} 弃牌异常: {}", players[currIdx]->id, PlayErrorName[static_cast<int>(err)]);
                     // 强制弃牌
-                    std::vector<CardPtr> dCards = players[currIdx]->discardMoreCard();
-                    for (auto &card : dCards)
-                        cards.emplace_back(std::move(card));
+                    discardExcess(currIdx);
                     return;
                 }
                 isContinue = false;
             }
             else {
                 spdlog::info("玩家 {} 回合未出牌, 强制结束", players[currIdx]->id);
-                std::vector<CardPtr> dCards = players[currIdx]->discardMoreCard();
-                for (auto &card : dCards)
-                    cards.emplace_back(std::move(card));
+                discardExcess(currIdx);
                 isContinue = false;
             }
         }
@@ -150,20 +275,15 @@ namespace kc {
     }
 
     /// @brief 处理卡牌效果
-    /// @param action 玩家出牌动作
+    /// @param action 玩家出牌动作, 须已通过 validatePlay
     void GameController::dealWithCard(const CardAction& action) {
+        metrics::ScopedTimer timer(action.type);
         removeCard(action);
-        static auto rand_eng = std::default_random_engine(std::random_device()());
+        thread_local auto rand_eng = std::default_random_engine(std::random_device()());
         if (action.type == CardType::SLASH) {
-            if (action.target_id == currIdx)
-                throw std::invalid_argument("不能对自己使用杀");
-//            else if (!isNearby(action.target_id))
-//                throw std::invalid_argument("目标不在攻击范围内");
-            else if (!findPlayerById(action.target_id).isAlive())
-                throw std::invalid_argument("目标已经死亡");
             playingId = action.target_id;
             bcStatus();
-            std::optional<CardAction> rslt = waitForReact({action.target_id}, TurnType::DODGE_WAIT);
+            std::optional<CardAction> rslt = waitForReact(action.target_id, TurnType::DODGE_WAIT);
             if (rslt.has_value()) {
                 spdlog::info("玩家 {} 对玩家 {} 使用杀, 已闪避", players[currIdx]->id, action.target_id);
                 removeCard(rslt.value());
@@ -174,66 +294,51 @@ namespace kc {
             }
         }
         else if (action.type == CardType::PEACH) {
-            if (players[currIdx]->getHealth() + 1 > players[currIdx]->getMaxHealth())
-                throw std::invalid_argument("玩家满血不能使用桃");
-            players[currIdx]->setHealth(players[currIdx]->getHealth() + 1);
+            ++table.hp[currIdx];
         }
         else if (action.type == CardType::DISMANTLE) {
-            if (action.target_id == currIdx)
-                throw std::invalid_argument("不能对自己使用过河拆桥");
-            else if (!findPlayerById(action.target_id).isAlive())
-                throw std::invalid_argument("目标已经死亡");
             playingId = action.target_id;
             bcStatus();
-            std::optional<CardAction> rslt = waitForReact({action.target_id}, TurnType::PASSIVE);
+            std::optional<CardAction> rslt = waitForReact(action.target_id, TurnType::PASSIVE);
             if (rslt.has_value()) {
                 spdlog::info("玩家 {} 对玩家 {} 使用过河拆桥, 已无懈可击", players[currIdx]->id, action.target_id);
                 removeCard(rslt.value());
             }
             else {
                 spdlog::info("玩家 {} 对玩家 {} 使用过河拆桥", players[currIdx]->id, action.target_id);
-                auto& player = findPlayerById(action.target_id);
-                auto rand = std::uniform_int_distribution<size_t>(0, player.getCardCount() - 1);
-                size_t rand_num = rand(rand_eng);
-                CardPtr card = player.removeCardByNum(rand_num);
-                spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
-                cards.emplace_back(std::move(card));
+                size_t seat = seatOf(action.target_id);
+                if (table.cardCount[seat] > 0) {
+                    auto rand = std::uniform_int_distribution<size_t>(0, table.cardCount[seat] - 1);
+                    CardPtr card = takeCardByNum(seat, rand(rand_eng));
+                    spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
+                    cards.emplace_back(std::move(card));
+                }
             }
         }
         else if (action.type == CardType::STEAL) {
-            if (action.target_id == currIdx)
-                throw std::invalid_argument("不能对自己使用顺手牵羊");
-//            else if (!isNearby(action.target_id))
-//                throw std::invalid_argument("目标不在攻击范围内");
-            else if (!findPlayerById(action.target_id).isAlive())
-                throw std::invalid_argument("目标已经死亡");
             playingId = action.target_id;
             bcStatus();
-            std::optional<CardAction> rslt = waitForReact({action.target_id}, TurnType::PASSIVE);
+            std::optional<CardAction> rslt = waitForReact(action.target_id, TurnType::PASSIVE);
             if (rslt.has_value()) {
                 spdlog::info("玩家 {} 对玩家 {} 使用顺手牵羊, 已无懈可击", players[currIdx]->id, action.target_id);
                 removeCard(rslt.value());
             }
             else {
                 spdlog::info("玩家 {} 对玩家 {} 使用顺手牵羊", players[currIdx]->id, action.target_id);
-                auto& player = findPlayerById(action.target_id);
-                auto rand = std::uniform_int_distribution<size_t>(0, player.getCardCount() - 1);
-                size_t rand_num = rand(rand_eng);
-                CardPtr card = player.removeCardByNum(rand_num);
-                spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
-                players[currIdx]->addCard(std::move(card));
+                size_t seat = seatOf(action.target_id);
+                if (table.cardCount[seat] > 0) {
+                    auto rand = std::uniform_int_distribution<size_t>(0, table.cardCount[seat] - 1);
+                    std::vector<CardPtr> card_to_add;
+                    card_to_add.emplace_back(takeCardByNum(seat, rand(rand_eng)));
+                    spdlog::info("id: {} type: {}", card_to_add[0]->id, CardName[card_to_add[0]->type]);
+                    giveCards(currIdx, std::move(card_to_add));
+                }
             }
         }
         else if (action.type == CardType::DUEL) {
-            if (action.target_id == currIdx)
-                throw std::invalid_argument("不能对自己使用决斗");
-//            else if (!isNearby(action.target_id))
-//                throw std::invalid_argument("目标不在攻击范围内");
-            else if (!findPlayerById(action.target_id).isAlive())
-                throw std::invalid_argument("目标已经死亡");
             playingId = action.target_id;
             bcStatus();
-            std::optional<CardAction> rslt = waitForReact({action.target_id}, TurnType::PASSIVE_SLASH);
+            std::optional<CardAction> rslt = waitForReact(action.target_id, TurnType::PASSIVE_SLASH);
             if (rslt.has_value()) {
                 if (rslt.value().type == CardType::UNRELENTING) {
                     spdlog::info("玩家 {} 对玩家 {} 使用决斗, 已无懈可击", players[currIdx]->id, action.target_id);
@@ -245,7 +350,7 @@ namespace kc {
                     while (true) {
                         playingId = players[currIdx]->id;
                         bcStatus();
-                        std::optional<CardAction> d_rslt1 = waitForReact({players[currIdx]->id}, TurnType::DUELING);
+                        std::optional<CardAction> d_rslt1 = waitForReact(players[currIdx]->id, TurnType::DUELING);
                         if (d_rslt1.has_value()) {
                             spdlog::info("玩家 {} 在与玩家 {} 决斗中打出杀", players[currIdx]->id, action.target_id);
                             removeCard(d_rslt1.value());
@@ -256,10 +361,10 @@ namespace kc {
                         }
                         playingId = action.target_id;
                         bcStatus();
-                        std::optional<CardAction> d_rslt2 = waitForReact({action.target_id}, TurnType::DUELING);
+                        std::optional<CardAction> d_rslt2 = waitForReact(action.target_id, TurnType::DUELING);
                         if (d_rslt2.has_value()) {
                             spdlog::info("玩家 {} 在与玩家 {} 决斗中打出杀", action.target_id, players[currIdx]->id);
-                            removeCard(d_rslt1.value());
+                            removeCard(d_rslt2.value());
                         } else {
                             spdlog::info("玩家 {} 在与玩家 {} 决斗中失败而受伤", action.target_id, players[currIdx]->id);
                             damage(action.target_id);
@@ -275,31 +380,31 @@ namespace kc {
         }
         else if (action.type == CardType::ARCHERY_VOLLEY) {
             spdlog::info("玩家 {} 使用万箭齐发", players[currIdx]->id);
-            for (size_t i = 1; i < players.size(); ++i) {
-                size_t idx = (currIdx + i) % players.size();
-                spdlog::info("玩家 {} 被万箭齐发攻击", players[idx]->id);
-                std::optional<CardAction> rslt = waitForReact({players[idx]->id}, TurnType::PASSIVE_DODGE);
+            for (size_t idx = table.nextAliveSeat(currIdx); idx != currIdx && idx != NO_SEAT;
+                 idx = table.nextAliveSeat(idx)) {
+                spdlog::info("玩家 {} 被万箭齐发攻击", table.id[idx]);
+                std::optional<CardAction> rslt = waitForReact(table.id[idx], TurnType::PASSIVE_DODGE);
                 if (rslt.has_value()) {
-                    spdlog::info("玩家 {} 对万箭齐发使用 {}", players[idx]->id, CardName[rslt.value().type]);
+                    spdlog::info("玩家 {} 对万箭齐发使用 {}", table.id[idx], CardName[rslt.value().type]);
                     removeCard(rslt.value());
                 } else {
-                    spdlog::info("玩家 {} 因万箭齐发受伤", players[idx]->id);
-                    damage(players[idx]->id);
+                    spdlog::info("玩家 {} 因万箭齐发受伤", table.id[idx]);
+                    damage(table.id[idx]);
                 }
             }
         }
         else if (action.type == CardType::BARBARIAN) {
             spdlog::info("玩家 {} 使用南蛮入侵", players[currIdx]->id);
-            for (size_t i = 1; i < players.size(); ++i) {
-                size_t idx = (currIdx + i) % players.size();
-                spdlog::info("玩家 {} 被南蛮入侵攻击", players[idx]->id);
-                std::optional<CardAction> rslt = waitForReact({players[idx]->id}, TurnType::PASSIVE_SLASH);
+            for (size_t idx = table.nextAliveSeat(currIdx); idx != currIdx && idx != NO_SEAT;
+                 idx = table.nextAliveSeat(idx)) {
+                spdlog::info("玩家 {} 被南蛮入侵攻击", table.id[idx]);
+                std::optional<CardAction> rslt = waitForReact(table.id[idx], TurnType::PASSIVE_SLASH);
                 if (rslt.has_value()) {
-                    spdlog::info("玩家 {} 对南蛮入侵使用 {}", players[idx]->id, CardName[rslt.value().type]);
+                    spdlog::info("玩家 {} 对南蛮入侵使用 {}", table.id[idx], CardName[rslt.value().type]);
                     removeCard(rslt.value());
                 } else {
-                    spdlog::info("玩家 {} 因南蛮入侵受伤", players[idx]->id);
-                    damage(players[idx]->id);
+                    spdlog::info("玩家 {} 因南蛮入侵受伤", table.id[idx]);
+                    damage(table.id[idx]);
                 }
             }
         }
@@ -313,63 +418,124 @@ namespace kc {
             else {
                 spdlog::info("玩家 {} 使用无中生有", players[currIdx]->id);
                 std::vector<CardPtr> card_to_add;
-                card_to_add.emplace_back(drawCard());
-                card_to_add.emplace_back(drawCard());
+                drawCards(card_to_add, 2);
                 for (const auto &card : card_to_add)
                     spdlog::info("id: {} type: {}", card->id, CardName[card->type]);
-                players[currIdx]->newCardList(std::move(card_to_add));
+                giveCards(currIdx, std::move(card_to_add));
             }
         }
         else if (action.type == CardType::HARVEST_FEAST) {
             spdlog::info("玩家 {} 使用五谷丰登", players[currIdx]->id);
-            for (auto& player : players) {
-                spdlog::debug("玩家 {} 受到五谷丰登", player->id);
+            for (size_t seat = 0; seat < table.size; ++seat) {
+                if (!table.alive[seat])
+                    continue;
+                spdlog::debug("玩家 {} 受到五谷丰登", table.id[seat]);
                 std::vector<CardPtr> card_to_add;
-                card_to_add.emplace_back(drawCard());
-                card_to_add.emplace_back(drawCard());
+                drawCards(card_to_add, 2);
                 for (const auto &card : card_to_add)
                     spdlog::debug("id: {} type: {}", card->id, CardName[card->type]);
-                player->newCardList(std::move(card_to_add));
+                giveCards(seat, std::move(card_to_add));
             }
         }
         else if (action.type == CardType::PEACH_GARDEN_OATH) {
             spdlog::info("玩家 {} 使用桃园结义", players[currIdx]->id);
-            for (auto& player : players)
-                if (player->getHealth() < player->getMaxHealth())
-                    player->setHealth(player->getHealth() + 1);
-        }
-        else {
-            throw std::invalid_argument("错误的卡牌使用");
+            for (size_t seat = 0; seat < table.size; ++seat)
+                if (table.alive[seat] && table.hp[seat] < table.maxHp[seat])
+                    ++table.hp[seat];
         }
         playingId = players[currIdx]->id;
         bcStatus();
     }
 
+    /// @brief 主动出牌的完整校验, 在广播之前调用, 不修改任何状态
+    PlayError GameController::validatePlay(const CardAction& action) const {
+        PlayError err = checkOwnership(action.source_id, action.card_id, action.type);
+        return err != PlayError::NONE ? err : checkTarget(action);
+    }
+
+    /// @brief 检查主动出牌的牌型与目标是否合法
+    PlayError GameController::checkTarget(const CardAction& action) const {
+        if (!(cardMask(TurnType::ACTIVE) & (1u << action.type)))
+            return PlayError::NOT_PLAYABLE;
+        switch (action.type) {
+            case CardType::SLASH:
+            case CardType::DISMANTLE:
+            case CardType::STEAL:
+            case CardType::DUEL: {
+                size_t seat = table.seatOf(action.target_id);
+                if (seat == NO_SEAT)
+                    return PlayError::NO_SUCH_PLAYER;
+                if (seat == currIdx)
+                    return PlayError::SELF_TARGET;
+                if (!table.alive[seat])
+                    return PlayError::TARGET_DEAD;
+                // 暂不限制攻击范围 (isNearby)
+                break;
+            }
+            case CardType::PEACH:
+                if (table.hp[currIdx] >= table.maxHp[currIdx])
+                    return PlayError::FULL_HEALTH;
+                break;
+            default:
+                break;
+        }
+        return PlayError::NONE;
+    }
+
+    /// @brief 检查玩家是否持有这张牌且类型与声明一致
+    PlayError GameController::checkOwnership(size_t player_id, size_t card_id, CardType type) const {
+        size_t seat = table.seatOf(player_id);
+        if (seat == NO_SEAT)
+            return PlayError::NO_SUCH_PLAYER;
+        size_t idx = table.cardIndex(card_id);
+        if (idx == NO_CARD || table.cardOwner[idx] != seat)
+            return PlayError::NOT_IN_HAND;
+        if (table.cardType[idx] != type)
+            return PlayError::WRONG_TYPE;
+        return PlayError::NONE;
+    }
+
+    /// @brief 回合结束时的弃牌, 全部校验通过后才移除
+    PlayError GameController::discardCards(const DiscardAction& action) {
+        size_t seat = seatOf(action.player_id);
+        for (size_t i = 0; i < action.card_ids.size(); ++i) {
+            size_t idx = table.cardIndex(action.card_ids[i]);
+            if (idx == NO_CARD || table.cardOwner[idx] != seat)
+                return PlayError::NOT_IN_HAND;
+            for (size_t j = 0; j < i; ++j)
+                if (action.card_ids[j] == action.card_ids[i])
+                    return PlayError::DUPLICATE_CARD;
+        }
+        if (table.cardCount[seat] - action.card_ids.size() > table.hp[seat])
+            return PlayError::TOO_FEW_DISCARDS;
+        for (size_t card_id : action.card_ids)
+            removeCard(action.player_id, card_id);
+        return PlayError::NONE;
+    }
+
     /// @brief 检查游戏是否结束
     bool GameController::checkWin() {
         size_t alive[4] = {0};
-        for (const auto &player : players) {
-            if (player->isAlive())
-                ++alive[player->getIdentity() - 1];
-        }
+        for (size_t seat = 0; seat < table.size; ++seat)
+            if (table.alive[seat])
+                ++alive[table.identity[seat] - 1];
         GameOver cmd;
         if (alive[0] == 0) {
             // 反贼胜利
             spdlog::info("反贼胜利");
             cmd.set_victorycamp(PlayerIdentity_pb::REBEL);
-            broadcast(CommandType::GAME_OVER, cmd.SerializeAsString());
+            broadcast(CommandType::GAME_OVER, cmd);
             return true;
         } else if (alive[0] > 0 && alive[2] == 0) {
             // 主公胜利
             spdlog::info("主公胜利");
             cmd.set_victorycamp(PlayerIdentity_pb::LORD);
-            broadcast(CommandType::GAME_OVER, cmd.SerializeAsString());
+            broadcast(CommandType::GAME_OVER, cmd);
             return true;
         } else if (alive[0] == 0 && alive[1] == 0 && alive[2] == 0 && alive[3] > 0) {
             // 内奸胜利
-            broadcast(CommandType::GAME_OVER, "内奸胜利");
             cmd.set_victorycamp(PlayerIdentity_pb::SPY);
-            broadcast(CommandType::GAME_OVER, cmd.SerializeAsString());
+            broadcast(CommandType::GAME_OVER, cmd);
             return true;
         }
         else if (alive[0] == 0 && alive[1] == 0 && alive[2] == 0 && alive[3] == 0) {
@@ -6,6 +6,10 @@
 #include <stdexcept>
 #include <spdlog/spdlog.h>
 #include "basic/Utility.h"
+#include "basic/Metrics.h"
+#include "basic/BotPlayer.h"
+#include "basic/StaticVector.h"
+#include "basic/WireCodec.h"
 #include "basic_message.pb.h"
 #include "basic_object.pb.h"
 #include "command.pb.h"
@@ -14,22 +18,18 @@ namespace kc {
 
     /// @brief 发送开始游戏消息
     void GameController::startCommand() {
-        for (const auto &player : players) {
+        for (size_t seat = 0; seat < table.size; ++seat) {
             GameStart cmd;
-            cmd.set_playeridentity(util::to_pb(player->getIdentity()));
+            cmd.set_playeridentity(util::to_pb(table.identity[seat]));
             cmd.set_lordid(lordId);
-            util::sendCommand(player, CommandType::GAME_START, cmd.SerializeAsString());
+            util::sendCommand(*players[seat], CommandType::GAME_START, cmd);
+        }
+        // 观众只知道主公是谁
+        if (spectators != nullptr) {
+            GameStart cmd;
+            cmd.set_lordid(lordId);
+            spectators->publish(CommandType::GAME_START, cmd.SerializeAsString());
         }
-    }
-
-    /// @brief 获取玩家 id 列表
-    std::vector<size_t> GameController::getPlayerList(bool exclude_current) const {
-        size_t curr_id = players[currIdx]->id;
-        std::vector<size_t> player_list;
-        for (const auto &player : players)
-            if (exclude_current && player->id != curr_id)
-                player_list.emplace_back(player->id);
-        return player_list;
     }
 
     /// @brief 广播消息
@@ -40,33 +40,70 @@ namespace kc {
         for (const auto &player : players) {
             util::sendCommand(player, commandType, msg);
         }
+        if (spectators != nullptr)
+            spectators->publish(commandType, msg);
     }
 
-    /// @brief 获取下一个玩家的 id
-    size_t GameController::nextPlayerIdx() {
-        size_t idx = currIdx;
-        for (int i = 1; i <= players.size(); ++i) {
-            idx = (currIdx + i) % players.size();
-            if (players[idx]->isAlive()) {
-                currIdx = idx;
-                playingId = players[idx]->id;
-                spdlog::info("下一个玩家: {}", players[idx]->id);
-                return idx;
+    /// @brief 广播消息, 每种编码只序列化一次
+    /// @param commandType 消息类型
+    /// @param msg 消息内容
+    void GameController::broadcast(CommandType commandType, const google::protobuf::Message &msg) {
+        std::string payload = msg.SerializeAsString();
+        std::string packed;     // 紧凑编码的消息体与玩家无关, 第一次用到时编码
+        for (const auto &player : players) {
+            if (player->wireFormat != wire::PACKED) {
+                util::sendCommand(player, commandType, payload);
+                continue;
             }
+            if (packed.empty() && !util::encodePacked(commandType, msg, packed)) {
+                spdlog::error("无法以紧凑编码广播 {}", CommandType_Name(commandType));
+                continue;
+            }
+            util::sendPacked(*player, commandType, packed);
         }
-        throw std::runtime_error("没有下一个玩家");
+        // 观众频道始终使用 protobuf
+        if (spectators != nullptr)
+            spectators->publish(commandType, payload);
+    }
+
+    /// @brief 对局期间两次等待之间发给同一玩家的消息合为一帧, 如五谷丰登、万箭齐发引起的一连串通知
+    void GameController::holdOutput() {
+        for (const auto &player : players)
+            util::holdOutput(*player);
+    }
+
+    /// @brief 发出所有玩家攒下的消息, 在等待玩家之前调用
+    void GameController::flushOutput() {
+        for (const auto &player : players)
+            util::flushOutput(*player);
+    }
+
+    /// @brief 对局结束后恢复逐条发送, 玩家回到大厅时不再攒消息
+    void GameController::releaseOutput() {
+        for (const auto &player : players)
+            util::releaseOutput(*player);
+    }
+
+    /// @brief 获取下一个玩家的 id
+    size_t GameController::nextPlayerIdx() {
+        size_t idx = table.nextAliveSeat(currIdx);
+        if (idx == NO_SEAT)
+            throw std::runtime_error("没有下一个玩家");
+        currIdx = idx;
+        playingId = table.id[idx];
+        spdlog::info("下一个玩家: {}", table.id[idx]);
+        return idx;
     }
 
     /// @brief 广播游戏状态
     void GameController::bcStatus() {
+        metrics::ScopedTimer timer(metrics::Histogram::BC_STATUS);
         GameStatus cmd;
-        cmd.set_totalplayers(players.size());
-        for (const auto& player : players) {
-            Player_pb player_pb = util::to_pb(*player);
-            cmd.add_players()->CopyFrom(player_pb);
-        }
+        cmd.set_totalplayers(table.size);
+        for (size_t seat = 0; seat < table.size; ++seat)
+            cmd.add_players()->CopyFrom(util::to_pb(table, seat));
         cmd.set_currentturnplayerid(playingId);
-        broadcast(CommandType::GAME_STATUS, cmd.SerializeAsString());
+        broadcast(CommandType::GAME_STATUS, cmd);
     }
 
     /// @brief 抽牌
@@ -76,115 +113,173 @@ namespace kc {
         return std::move(card);
     }
 
-    /// @brief 根据 id 查找玩家
-    Player& GameController::findPlayerById(size_t id) {
-        for (const auto& player : players) {
-            if (player->id == id) {
-                return *player;
+    /// @brief 抽取至多 num 张牌, 牌堆不足时只抽剩余的牌
+    void GameController::drawCards(std::vector<CardPtr> &card_list, size_t num) {
+        for (size_t i = 0; i < num && !cards.empty(); ++i)
+            card_list.emplace_back(drawCard());
+    }
+
+    /// @brief 根据 id 查找座位
+    size_t GameController::seatOf(size_t id) const {
+        size_t seat = table.seatOf(id);
+        if (seat == NO_SEAT)
+            throw std::invalid_argument("玩家 id 不存在");
+        return seat;
+    }
+
+    /// @brief 为座位上的玩家添加一组新的手牌, 并且通知玩家
+    void GameController::giveCards(size_t seat, std::vector<CardPtr> &&card_list) {
+        for (const auto &card : card_list)
+            table.addCard(seat, *card);
+        players[seat]->newCardList(std::move(card_list));
+    }
+
+    /// @brief 根据序号从座位上的玩家手牌中取走一张牌
+    CardPtr GameController::takeCardByNum(size_t seat, size_t num) {
+        CardPtr card = players[seat]->removeCardByNum(num);
+        table.removeCard(seat, *card);
+        return card;
+    }
+
+    /// @brief 强制座位上的玩家弃掉超出体力的手牌, 放回牌堆
+    void GameController::discardExcess(size_t seat) {
+        std::vector<CardPtr> dCards = players[seat]->discardMoreCard(table.hp[seat]);
+        for (auto &card : dCards) {
+            table.removeCard(seat, *card);
+            cards.emplace_back(std::move(card));
+        }
+    }
+
+    /// @brief 等待玩家套接字可读或到达期限, 期限由共享的时间轮唤醒, 等待期间不再定期醒来
+    /// @param items 玩家套接字, 返回时保持原样
+    /// @param deadline 期限
+    /// @return 可读的套接字数, 到期时为 0
+    int GameController::pollUntil(PollItems &items, std::chrono::steady_clock::time_point deadline) {
+        // 等待之前把这段时间攒下的消息发出去
+        flushOutput();
+        ScheduledTimer alarm(deadline, [waker = waker]() { waker->notify(); });
+        int rtn = 0;
+        // 唤醒器可能残留上一次等待的通知, 醒来后总以时钟为准
+        while (rtn == 0 && std::chrono::steady_clock::now() < deadline) {
+            zmq::pollitem_t &wake = items.emplace_back(zmq::pollitem_t{nullptr, waker->getFd(), ZMQ_POLLIN, 0});
+            try {
+                rtn = zmq::poll(items.data(), items.size(), std::chrono::milliseconds(-1));
+            } catch (zmq::error_t &e) {
+                spdlog::error("Polling 出错: {}", e.what());
+                rtn = 0;
+            }
+            if (wake.revents & ZMQ_POLLIN) {
+                waker->drain();
+                --rtn;
             }
+            items.pop_back();
         }
-        throw std::invalid_argument("玩家 id 不存在");
+        return rtn;
+    }
+
+    /// @brief 通知玩家轮到他出牌
+    /// @param type 可以打出的牌的类型
+    /// @param deadline 服务器判定超时的时刻, 同时换算成客户端时钟下发
+    void GameController::sendYourTurn(Player &player, TurnType type, std::chrono::steady_clock::time_point deadline) {
+        YourTurn cmd;
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now());
+        cmd.set_remainingtime(static_cast<float>(std::max<int64_t>(remaining.count(), 0)) / 1000.0f);
+        cmd.set_turntype(util::to_pb(type));
+        cmd.set_deadline(util::toClientTime(player, deadline));
+        util::sendCommand(player, CommandType::YOUR_TURN, cmd);
     }
 
     /// @brief 等待玩家出牌
     /// @param target 目标玩家 id 列表
-    /// @return CardAction / DiscardAction
-    std::any GameController::waitForCard(const std::vector<size_t> &target) {
-        std::vector<zmq::pollitem_t> poll_items;
-        std::vector<std::unique_lock<std::mutex>> locks;
-        poll_items.reserve(target.size());
+    /// @param deadline 超时的时刻, 与 YOUR_TURN 中下发的一致
+    /// @return CardAction / DiscardAction / Timeout
+    TurnResult GameController::waitForCard(IdSpan target, std::chrono::steady_clock::time_point deadline) {
+        metrics::ScopedTimer timer(metrics::Histogram::WAIT_FOR_CARD);
+        // 机器人直接同步决策, 不经过网络
+        if (target.size() == 1 && players[seatOf(target[0])]->isBot()) {
+            size_t seat = seatOf(target[0]);
+            auto &bot = static_cast<BotPlayer &>(*players[seat]);
+            std::optional<CardAction> action = bot.decideTurn(table, seat, lordId);
+            if (action.has_value() && validatePlay(action.value()) != PlayError::NONE) {
+                spdlog::error("机器人 {} 出牌不合法, 改为弃牌", bot.id);
+                action.reset();
+            }
+            if (action.has_value()) {
+                spdlog::info("机器人 {} 出牌: {} {}", bot.id, action->card_id, CardName[action->type]);
+                bcCard(action.value());     // 广播出牌
+                return action.value();
+            }
+            spdlog::info("机器人 {} 弃牌", bot.id);
+            return bot.decideDiscard(table.hp[seat]);
+        }
+        PollItems poll_items;
         for (size_t id : target) {
-            Player& rslt = findPlayerById(id);
+            Player& rslt = *players[seatOf(id)];
             poll_items.emplace_back(zmq::pollitem_t{rslt.socket, 0, ZMQ_POLLIN, 0});
-            locks.emplace_back(rslt.mtx, std::defer_lock);
         }
-        while (TURN_TIME_LIMIT - turn_timer.getTime() > std::chrono::microseconds(0)) {
-            spdlog::debug("Polling, 剩余时间: {} ms", (TURN_TIME_LIMIT - turn_timer.getTime()).count());
-            for (auto& lock : locks)
-                lock.lock();
-            int rtn;
-            try {
-                rtn = zmq::poll(poll_items, std::chrono::milliseconds(1000));
-            } catch (zmq::error_t &e) {
-                spdlog::error("Polling 出错: {}", e.what());
-                continue;
-            }
-            for (auto& lock : locks)
-                lock.unlock();
-            if (rtn == 0) {
-                spdlog::debug("Polling 超时");
-                continue;
-            }
-            unsigned rep_id = rtn - 1;
-            spdlog::debug("接收到玩家 {} 的 revents: {}", target[rep_id], poll_items[rep_id].revents);
-            if (poll_items[rep_id].revents & ZMQ_POLLIN) {
-                spdlog::debug("玩家 {} 有响应", target[rep_id]);
-                try {
-                    std::string msg;
-                    std::optional<CommandType> rslt = util::recvCommand(findPlayerById(target[rep_id]), msg);
-                    if (!rslt.has_value())
-                        throw std::runtime_error("接收到空消息");
-                    if (rslt.value() == CommandType::ACTION_PLAY) {
-                        ActionPlay cmd;
-                        cmd.ParseFromString(msg);
-                        spdlog::info("玩家 {} 出牌: {} {}", target[rep_id], cmd.card().id(),
-                                     CardName[cmd.card().type()]);
-                        CardAction action{
-                                cmd.card().id(),
-                                util::to_kc(cmd.card().type()),
-                                target[rep_id],
-                                cmd.targetplayerid()
-                        };
-                        bcCard(action);     // 广播出牌
-                        return action;
-                    } else if (rslt.value() == CommandType::ACTION_PASS) {
-                        ActionPass cmd;
-                        cmd.ParseFromString(msg);
-                        std::set<size_t> card_ids;
-                        for (const auto &card: cmd.discardedcards()) {
-                            card_ids.emplace(card.id());
-                        }
-                        spdlog::info("玩家 {} 弃牌", target[rep_id]);
-                        return DiscardAction{
-                                target[rep_id],
-                                std::move(card_ids)
-                        };
-                    } else
-                        throw std::runtime_error("错误的消息类型");
-                } catch (std::exception &e) {
-                    spdlog::error("玩家 {} 发送错误信息: {}", target[rep_id], e.what());
+        while (pollUntil(poll_items, deadline) > 0) {
+            for (size_t i = 0; i < poll_items.size(); ++i) {
+                if (!(poll_items[i].revents & ZMQ_POLLIN))
                     continue;
+                spdlog::debug("玩家 {} 有响应", target[i]);
+                // 错误的消息只记录并继续等待, 不抛出异常
+                std::string msg;
+                Player &sender = *players[seatOf(target[i])];
+                std::optional<CommandType> rslt = util::recvCommand(sender, msg);
+                if (!rslt.has_value())
+                    continue;
+                if (rslt.value() == CommandType::ACTION_PLAY) {
+                    ActionPlay cmd;
+                    if (!util::parsePayload(sender, CommandType::ACTION_PLAY, msg, cmd) || !CardType_pb_IsValid(cmd.card().type())) {
+                        spdlog::error("玩家 {} 发送错误信息: 无法解析出牌", target[i]);
+                        continue;
+                    }
+                    CardAction action{
+                            cmd.card().id(),
+                            util::to_kc(cmd.card().type()),
+                            target[i],
+                            cmd.targetplayerid()
+                    };
+                    // 先校验再广播, 非法出牌只通知出牌者, 继续等待
+                    PlayError err = validatePlay(action);
+                    if (err != PlayError::NONE) {
+                        rejectPlay(action, err);
+                        continue;
+                    }
+                    spdlog::info("玩家 {} 出牌: {} {}", target[i], action.card_id, CardName[action.type]);
+                    bcCard(action);     // 广播出牌
+                    return action;
+                } else if (rslt.value() == CommandType::ACTION_PASS) {
+                    ActionPass cmd;
+                    if (!util::parsePayload(sender, CommandType::ACTION_PASS, msg, cmd)) {
+                        spdlog::error("玩家 {} 发送错误信息: 无法解析弃牌", target[i]);
+                        continue;
+                    }
+                    DiscardAction action{target[i]};
+                    for (const auto &card: cmd.discardedcards()) {
+                        if (action.card_ids.size() == action.card_ids.capacity())
+                            break;      // 超出整副牌的张数, 交给 discardCards 判为非法
+                        action.card_ids.push_back(card.id());
+                    }
+                    spdlog::info("玩家 {} 弃牌", target[i]);
+                    return action;
+                } else {
+                    spdlog::error("玩家 {} 发送错误信息: 错误的消息类型", target[i]);
                 }
-            } else {
-                spdlog::error("玩家 {} 未知的 revents", target[rep_id]);
-                continue;
             }
         }
-        return std::nullopt;
+        metrics::increment(metrics::Counter::TURN_TIMEOUTS);
+        return Timeout{};
     }
 
     /// @brief 判断目标玩家是否在当前玩家的左右
     /// @param target_id 目标玩家 id
     /// @return 是否在左右
     bool GameController::isNearby(size_t target_id) {
-        // 要求死的玩家跳过, 直接继续寻找
-        for (int i = 1; i < players.size(); ++i) {
-            size_t idx_l = (currIdx + players.size() - i) % players.size();
-            if (players[idx_l]->isAlive()) {
-                if (players[idx_l]->id == target_id)
-                    return true;
-                break;
-            }
-        }
-        for (int i = 1; i < players.size(); ++i) {
-            size_t idx_r = (currIdx + i) % players.size();
-            if (players[idx_r]->isAlive()) {
-                if (players[idx_r]->id == target_id)
-                    return true;
-                break;
-            }
-        }
-        return false;
+        // 死的玩家已从存活环中摘除
+        size_t seat = table.seatOf(target_id);
+        return seat != NO_SEAT && table.alive[seat] && table.isNeighbor(currIdx, seat);
     }
 
     /// @brief 广播出牌动作
@@ -194,71 +289,114 @@ namespace kc {
         card_pb.set_id(action.card_id);
         card_pb.set_type(util::to_pb(action.type));
         cmd.mutable_card()->CopyFrom(card_pb);
+        cmd.set_playerid(action.source_id);
         cmd.set_targetplayerid(action.target_id);
-        broadcast(CommandType::NOTICE_CARD, cmd.SerializeAsString());
+        broadcast(CommandType::NOTICE_CARD, cmd);
+    }
+
+    /// @brief 拒绝非法出牌, 只通知出牌的玩家, 不广播
+    /// @param action 被拒绝的出牌
+    /// @param err 拒绝原因
+    void GameController::rejectPlay(const CardAction& action, PlayError err) {
+        spdlog::error("玩家 {} 出牌异常: {}", action.source_id, PlayErrorName[static_cast<int>(err)]);
+        metrics::increment(metrics::Counter::INVALID_PLAYS);
+        size_t seat = table.seatOf(action.source_id);
+        if (seat == NO_SEAT)
+            return;
+        ActionReject cmd;
+        cmd.mutable_card()->set_id(action.card_id);
+        cmd.mutable_card()->set_type(util::to_pb(action.type));
+        cmd.set_reason(util::to_pb(err));
+        util::sendCommand(*players[seat], CommandType::ACTION_REJECT, cmd);
     }
 
     /// @brief 等待玩家反应, 仅在目标玩家可反应时返回
     /// @param target_id 目标玩家 id 列表
     /// @param card_type 可以反应的牌的类型
+    /// @param subject_id 被指定或濒死的玩家 id, 供机器人判断是否需要反应
     /// @return 反应的牌的类型
-    std::optional<CardAction> GameController::waitForReact(const std::vector<size_t> &target, TurnType type) {
-        std::vector<zmq::pollitem_t> poll_items(target.size());
-        std::vector<bool> pass(target.size(), false);
-        auto type_check = TurnCardsAvailable.at(type);
-        YourTurn cmd_;
-        cmd_.set_remainingtime(REACT_TIME_LIMIT.count());
-        cmd_.set_turntype(util::to_pb(type));
+    std::optional<CardAction> GameController::waitForReact(IdSpan target, TurnType type,
+                                                           size_t subject_id) {
+        metrics::ScopedTimer timer(metrics::Histogram::WAIT_FOR_REACT);
+        uint32_t mask = cardMask(type);
+        // 机器人立即决策, 有反应则直接返回
+        for (size_t id : target) {
+            size_t seat = seatOf(id);
+            Player& rslt = *players[seat];
+            if (!rslt.isBot() || !table.alive[seat])
+                continue;
+            bool is_subject = rslt.id == subject_id || target.size() == 1;
+            std::optional<CardAction> action = static_cast<BotPlayer&>(rslt).decideReact(type, is_subject);
+            if (action.has_value()) {
+                spdlog::info("机器人 {} 出牌: {} {}", id, action->card_id, CardName[action->type]);
+                bcCard(action.value());     // 广播出牌
+                return action;
+            }
+        }
+        PollItems poll_items;
+        StaticVector<size_t, MAX_PLAYER_NUM> polled;
+        auto deadline = std::chrono::steady_clock::now() + rules.reactTimeLimit;
         for (size_t id : target) {
-            Player& rslt = findPlayerById(id);
-            if (rslt.hasCard(type_check)) {
+            size_t seat = seatOf(id);
+            Player& rslt = *players[seat];
+            if (!rslt.isBot() && table.alive[seat] && table.hasCard(seat, mask)) {
                 poll_items.emplace_back(zmq::pollitem_t{rslt.socket, 0, ZMQ_POLLIN, 0});
-                util::sendCommand(rslt, CommandType::YOUR_TURN, cmd_.SerializeAsString());
+                polled.emplace_back(id);
+                sendYourTurn(rslt, type, deadline);
             }
         }
-        zmq::poll(poll_items, std::chrono::duration_cast<std::chrono::milliseconds>(REACT_TIME_LIMIT));
-        for (size_t i = 0; i < target.size(); ++i) {
-            if (poll_items[i].revents & ZMQ_POLLIN) {
-                try {
-                    std::string msg;
-                    std::optional<CommandType> rslt = util::recvCommand(players[target[i]], msg);
-                    if (!rslt.has_value())
-                        throw std::runtime_error("接收到空消息");
-                    if (rslt.value() == CommandType::ACTION_PLAY) {
-                        ActionPlay cmd;
-                        cmd.ParseFromString(msg);
-                        if (type_check.find(util::to_kc(cmd.card().type())) == type_check.end())
-                            throw std::runtime_error("错误的反应牌类型");
-                        spdlog::info("玩家 {} 出牌: {} {}", target[i], cmd.card().id(), CardName[cmd.card().type()]);
-                        CardAction action {
-                                cmd.card().id(),
-                                util::to_kc(cmd.card().type()),
-                                target[i],
-                                cmd.targetplayerid()
-                        };
-                        bcCard(action);     // 广播出牌
-                        return action;
+        if (polled.empty()) {
+            metrics::increment(metrics::Counter::REACT_TIMEOUTS);
+            return std::nullopt;
+        }
+        size_t pass_count = 0;
+        while (pollUntil(poll_items, deadline) > 0) {
+            for (size_t i = 0; i < polled.size(); ++i) {
+                if (!(poll_items[i].revents & ZMQ_POLLIN))
+                    continue;
+                // 错误或非法的反应只记录并继续等待, 不抛出异常
+                std::string msg;
+                Player &sender = *players[seatOf(polled[i])];
+                std::optional<CommandType> rslt = util::recvCommand(sender, msg);
+                if (!rslt.has_value())
+                    continue;
+                if (rslt.value() == CommandType::ACTION_PLAY) {
+                    ActionPlay cmd;
+                    if (!util::parsePayload(sender, CommandType::ACTION_PLAY, msg, cmd) || !CardType_pb_IsValid(cmd.card().type())) {
+                        spdlog::error("玩家 {} 发送错误信息: 无法解析出牌", polled[i]);
+                        continue;
                     }
-                    else if (rslt.value() == CommandType::ACTION_PASS) {
-                        // 跳过判断
-                        pass[i] = true;
-                        bool is_pass = true;
-                        for (bool p : pass)
-                            if (!p) {
-                                is_pass = false;
-                                break;
-                            }
-                        if (is_pass)
-                            return std::nullopt;
+                    CardAction action {
+                            cmd.card().id(),
+                            util::to_kc(cmd.card().type()),
+                            polled[i],
+                            cmd.targetplayerid()
+                    };
+                    PlayError err = mask & (1u << action.type)
+                                    ? checkOwnership(action.source_id, action.card_id, action.type)
+                                    : PlayError::NOT_PLAYABLE;
+                    if (err != PlayError::NONE) {
+                        rejectPlay(action, err);
+                        continue;
                     }
-                    else
-                        throw std::runtime_error("错误的消息类型");
-                } catch (std::exception &e) {
-                    spdlog::error("玩家 {} 发送错误信息: {}", target[i], e.what());
-                    continue;
+                    spdlog::info("玩家 {} 出牌: {} {}", polled[i], action.card_id, CardName[action.type]);
+                    bcCard(action);     // 广播出牌
+                    return action;
                 }
+                else if (rslt.value() == CommandType::ACTION_PASS) {
+                    // 跳过判断, 已跳过的玩家不再监听
+                    if (poll_items[i].events != 0) {
+                        poll_items[i].events = 0;
+                        ++pass_count;
+                    }
+                    if (pass_count == polled.size())
+                        return std::nullopt;
+                }
+                else
+                    spdlog::error("玩家 {} 发送错误信息: 错误的消息类型", polled[i]);
             }
         }
+        metrics::increment(metrics::Counter::REACT_TIMEOUTS);
         return std::nullopt;
     }
 
@@ -267,9 +405,11 @@ namespace kc {
     /// @param card_id 牌 id
     /// @param type_check 牌类型检查
     void GameController::removeCard(size_t player_id, size_t card_id, std::optional<CardType> type_check) {
-        CardPtr card = findPlayerById(player_id).removeCard(card_id);
-        if (type_check.has_value() && card->type != type_check.value())
+        size_t seat = seatOf(player_id);
+        if (type_check.has_value() && checkOwnership(player_id, card_id, type_check.value()) != PlayError::NONE)
             throw std::invalid_argument("出牌类型不匹配");
+        CardPtr card = players[seat]->removeCard(card_id);
+        table.removeCard(seat, *card);
         spdlog::debug("玩家 {} 移除手牌: {} {}", player_id, card_id, CardName[card->type]);
         cards.emplace_back(std::move(card));
     }
@@ -283,46 +423,48 @@ namespace kc {
     /// @param player_id 玩家 id
     /// @param damage 伤害值
     void GameController::damage(size_t player_id, size_t damage) {
-        Player& target = findPlayerById(player_id);
-        if (!target.isAlive())
+        size_t seat = seatOf(player_id);
+        if (!table.alive[seat])
             throw std::invalid_argument("玩家已死亡");
-        if (target.getHealth() - damage <= 0) {
+        if (table.hp[seat] <= damage) {
             // 公告濒死状态
             NoticeDying cmd_dying;
             cmd_dying.set_playerid(player_id);
-            broadcast(CommandType::NOTICE_DYING, cmd_dying.SerializeAsString());
+            broadcast(CommandType::NOTICE_DYING, cmd_dying);
             // 等待玩家反应
-            std::optional<CardAction> action = waitForReact(getPlayerList(), TurnType::DYING);
+            std::optional<CardAction> action = waitForReact(getPlayerList(), TurnType::DYING, player_id);
             if (action.has_value()) {
                 if (action.value().type == CardType::PEACH) {
                     spdlog::info("玩家 {} 使用桃, 救了玩家 {}", action.value().source_id, player_id);
                     removeCard(action.value());
-                    target.setHealth(1);
+                    table.hp[seat] = 1;
                 }
                 else if (action.value().type == CardType::PEACH_GARDEN_OATH) {
                     spdlog::info("玩家 {} 使用桃园结义, 救了玩家 {}", action.value().source_id, player_id);
                     removeCard(action.value());
-                    target.setHealth(0);
-                    for (auto& player : players)
-                        if (player->getHealth() < player->getMaxHealth())
-                            player->setHealth(player->getHealth() + 1);
+                    table.hp[seat] = 0;
+                    for (size_t s = 0; s < table.size; ++s)
+                        if (table.alive[s] && table.hp[s] < table.maxHp[s])
+                            ++table.hp[s];
                 }
             }
             else {
-                std::vector<CardPtr> card_to_add = target.die();
+                std::vector<CardPtr> card_to_add = players[seat]->takeAllCards();
                 for (auto& card : card_to_add)
                     cards.emplace_back(std::move(card));
+                table.clearHand(seat);
+                table.kill(seat);
+                table.hp[seat] = 0;
                 // 公告死亡
                 NoticeDead cmd_dead;
                 cmd_dead.set_playerid(player_id);
-                broadcast(CommandType::NOTICE_DEAD, cmd_dead.SerializeAsString());
+                broadcast(CommandType::NOTICE_DEAD, cmd_dead);
                 spdlog::info("玩家 {} 死亡", player_id);
             }
         }
         else {
-            target.setHealth(target.getHealth() - damage);
-            spdlog::info("玩家 {} 受到 {} 点伤害, 剩余 {} 点生命值", player_id, damage, target.getHealth());
+            table.hp[seat] -= damage;
+            spdlog::info("玩家 {} 受到 {} 点伤害, 剩余 {} 点生命值", player_id, damage, table.hp[seat]);
         }
     }
 }
-
@@ -0,0 +1,127 @@
+
+#include "Matchmaker.h"
+
+#include <algorithm>
+#include <limits>
+#include "basic/Metrics.h"
+
+namespace kc {
+    /// @brief 等待一段时间后允许的同桌分差
+    uint32_t Matchmaker::spreadAfter(Clock::duration waited) const {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(waited).count();
+        uint64_t spread = config.baseSpread
+                          + static_cast<uint64_t>(std::max<int64_t>(ms, 0)) * config.spreadPerSecond / 1000;
+        return static_cast<uint32_t>(std::min<uint64_t>(spread, std::numeric_limits<uint32_t>::max()));
+    }
+
+    /// @brief 等待一段时间后要求的开桌人数, 在 patience 内从最大人数线性降到最小人数
+    size_t Matchmaker::targetAfter(Clock::duration waited) const {
+        if (waited >= config.patience)
+            return config.minTable;
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(waited).count();
+        auto patience = std::chrono::duration_cast<std::chrono::milliseconds>(config.patience).count();
+        size_t shrink = (config.maxTable - config.minTable) * static_cast<size_t>(std::max<int64_t>(ms, 0))
+                        / static_cast<size_t>(patience);
+        return config.maxTable - shrink;
+    }
+
+    /// @brief 玩家进入匹配队列, 已在队列中时按新的分数重新排队
+    /// @param player 玩家
+    /// @param rating 玩家的分数
+    /// @param now 入队时间
+    void Matchmaker::enqueue(PlayerPtr player, uint32_t rating, Clock::time_point now) {
+        uint64_t seq = nextSeq++;
+        index[player->id] = {seq, player};
+        buckets[rating / config.bucketWidth].push_back({std::move(player), rating, now, seq});
+    }
+
+    /// @brief 玩家离开匹配队列, 票据留在分段中, 下次 tick 时清理
+    /// @return 离开队列的玩家, 不在队列中时为空
+    PlayerPtr Matchmaker::remove(uint32_t player_id) {
+        auto it = index.find(player_id);
+        if (it == index.end())
+            return nullptr;
+        PlayerPtr player = std::move(it->second.second);
+        index.erase(it);
+        return player;
+    }
+
+    /// @brief 清空队列, 释放所有排队玩家
+    void Matchmaker::clear() {
+        buckets.clear();
+        index.clear();
+    }
+
+    /// @brief 清空队列, 返回所有仍在排队的玩家
+    std::vector<PlayerPtr> Matchmaker::takeAll() {
+        std::vector<PlayerPtr> queued;
+        queued.reserve(index.size());
+        for (auto &[id, entry] : index)
+            queued.push_back(std::move(entry.second));
+        clear();
+        return queued;
+    }
+
+    /// @brief 组桌
+    /// @details 按分数从低到高把仍在排队的玩家排成一列, 从每个位置起贪心地向后扩展,
+    ///          直到人数达到上限或分差超出组内等得最久的玩家所允许的范围;
+    ///          人数达到该玩家要求的人数就开桌, 否则从下一个位置重试. 耗时 O(n · maxTable)
+    /// @param now 当前时间
+    /// @return 组成的桌子, 每桌按分数顺序排列
+    std::vector<std::vector<PlayerPtr>> Matchmaker::tick(Clock::time_point now) {
+        auto isQueued = [this](const Ticket &ticket) {
+            auto it = index.find(ticket.player->id);
+            return it != index.end() && it->second.first == ticket.seq;
+        };
+        std::vector<const Ticket *> line;
+        line.reserve(index.size());
+        for (const auto &[bucket, queue] : buckets)
+            for (const auto &ticket : queue)
+                if (isQueued(ticket))
+                    line.push_back(&ticket);
+
+        std::vector<std::vector<PlayerPtr>> tables;
+        size_t i = 0;
+        while (i + config.minTable <= line.size()) {
+            uint32_t lo = line[i]->rating;
+            uint32_t hi = lo;
+            Clock::time_point oldest = line[i]->enqueued;
+            size_t j = i + 1;
+            while (j < line.size() && j - i < config.maxTable) {
+                uint32_t new_lo = std::min(lo, line[j]->rating);
+                uint32_t new_hi = std::max(hi, line[j]->rating);
+                Clock::time_point new_oldest = std::min(oldest, line[j]->enqueued);
+                if (new_hi - new_lo > spreadAfter(now - new_oldest))
+                    break;
+                lo = new_lo;
+                hi = new_hi;
+                oldest = new_oldest;
+                ++j;
+            }
+            if (j - i < targetAfter(now - oldest)) {
+                ++i;
+                continue;
+            }
+            std::vector<PlayerPtr> table;
+            table.reserve(j - i);
+            for (size_t k = i; k < j; ++k) {
+                metrics::Registry::instance().observe(metrics::Histogram::QUEUE_WAIT, now - line[k]->enqueued);
+                index.erase(line[k]->player->id);
+                table.push_back(line[k]->player);
+            }
+            tables.emplace_back(std::move(table));
+            metrics::increment(metrics::Counter::MATCHES_FORMED);
+            i = j;
+        }
+
+        // 清理已出队的票据与空分段
+        for (auto it = buckets.begin(); it != buckets.end();) {
+            auto &queue = it->second;
+            queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                       [&](const Ticket &ticket) { return !isQueued(ticket); }),
+                        queue.end());
+            it = queue.empty() ? buckets.erase(it) : std::next(it);
+        }
+        return tables;
+    }
+}
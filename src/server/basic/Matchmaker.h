@@ -0,0 +1,63 @@
+
+#ifndef KINGDOMCARD_MATCHMAKER_H
+#define KINGDOMCARD_MATCHMAKER_H
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "basic/Player.h"
+
+namespace kc {
+    struct MatchmakerConfig {
+        size_t minTable = MIN_PLAYER_NUM;               // 最小开桌人数
+        size_t maxTable = MAX_PLAYER_NUM;               // 最大开桌人数
+        uint32_t bucketWidth = 50;                      // 每个分段覆盖的分数范围
+        uint32_t baseSpread = 100;                      // 同桌玩家的初始分差上限
+        uint32_t spreadPerSecond = 25;                  // 每等待一秒放宽的分差
+        std::chrono::seconds patience {20};             // 等待这么久后接受最小人数开桌
+    };
+
+    /// @brief 按分数分段排队的匹配器
+    /// @details 入队只在对应分段的队尾追加, 分段按分数有序保存, 耗时 O(log n);
+    ///          每次 tick 按分数从低到高扫描, 等得越久的玩家允许的分差越大、要求的人数越少,
+    ///          以此在排队时间与桌子人数之间取舍. 非线程安全, 由调用方加锁
+    class Matchmaker {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Ticket {
+            PlayerPtr player;
+            uint32_t rating;
+            Clock::time_point enqueued;
+            uint64_t seq;                               // 与 index 中的不一致时说明已出队
+        };
+
+        MatchmakerConfig config;
+        std::map<uint32_t, std::deque<Ticket>> buckets; // 分段号 -> 该分段内按入队顺序排列的玩家
+        std::unordered_map<uint32_t, std::pair<uint64_t, PlayerPtr>> index;  // 玩家 id -> 有效票据的序号与玩家
+        uint64_t nextSeq = 0;
+
+        [[nodiscard]] uint32_t spreadAfter(Clock::duration waited) const;
+
+        [[nodiscard]] size_t targetAfter(Clock::duration waited) const;
+
+    public:
+        explicit Matchmaker(MatchmakerConfig config = {}) : config(config) {}
+
+        void enqueue(PlayerPtr player, uint32_t rating, Clock::time_point now = Clock::now());
+
+        PlayerPtr remove(uint32_t player_id);
+
+        void clear();
+
+        [[nodiscard]] std::vector<PlayerPtr> takeAll();
+
+        [[nodiscard]] std::vector<std::vector<PlayerPtr>> tick(Clock::time_point now = Clock::now());
+
+        [[nodiscard]] size_t size() const { return index.size(); }
+    };
+}
+
+#endif //KINGDOMCARD_MATCHMAKER_H
@@ -0,0 +1,153 @@
+
+#include "Metrics.h"
+
+#include <sstream>
+
+namespace kc::metrics {
+    namespace {
+        struct Descriptor {
+            const char *name;
+            const char *help;
+        };
+
+        Descriptor const CounterDescriptor[] = {
+                {"kc_messages_sent_total",     "成功发送给玩家的消息数"},
+                {"kc_send_failures_total",     "发送给玩家失败的消息数"},
+                {"kc_messages_received_total", "成功从玩家接收的消息数"},
+                {"kc_recv_failures_total",     "从玩家接收失败的消息数"},
+                {"kc_turn_timeouts_total",     "出牌超时而被强制结束的回合数"},
+                {"kc_react_timeouts_total",    "无人反应而结束的反应窗口数"},
+                {"kc_invalid_plays_total",     "被拒绝的非法出牌数"},
+                {"kc_snapshot_failures_total", "写入失败的对局快照数"},
+                {"kc_matches_formed_total",    "匹配器组成的对局数"},
+                {"kc_frames_sent_total",       "发给玩家的帧数, 合并帧使它少于消息数"},
+                {"kc_frames_compressed_total", "以 zstd 压缩的合并帧数"},
+        };
+
+        Descriptor const HistogramDescriptor[] = {
+                {"kc_send_command_seconds",  "util::sendCommand 耗时"},
+                {"kc_recv_command_seconds",  "util::recvCommand 耗时"},
+                {"kc_wait_for_card_seconds", "等待玩家出牌的耗时"},
+                {"kc_wait_for_react_seconds", "反应窗口的耗时"},
+                {"kc_bc_status_seconds",     "广播游戏状态的耗时"},
+                {"kc_snapshot_seconds",      "在回合边界生成并提交对局快照的耗时"},
+                {"kc_queue_wait_seconds",    "玩家在匹配队列中的等待时长"},
+                {"kc_deal_with_card_seconds", "结算卡牌效果的耗时"},
+        };
+
+        // Prometheus 标签使用 ASCII 名称
+        const char *const CardLabel[] = {"SLASH", "DODGE", "PEACH",
+                                         "DISMANTLE", "STEAL", "DUEL", "ARCHERY_VOLLEY", "BARBARIAN",
+                                         "SLEIGHT_OF_HAND", "HARVEST_FEAST", "PEACH_GARDEN_OATH",
+                                         "UNRELENTING"};
+
+        /// @brief 计算数值所在的桶, 前 8 个桶精确记录, 之后每个 2 的幂区间分为 8 个桶
+        size_t bucketOf(uint64_t value) {
+            if (value < SUB_BUCKET_COUNT)
+                return value;
+            size_t msb = 63 - __builtin_clzll(value);
+            size_t magnitude = msb - SUB_BUCKET_BITS + 1;
+            if (magnitude >= MAGNITUDE_COUNT)
+                return BUCKET_COUNT - 1;
+            size_t sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+            return magnitude * SUB_BUCKET_COUNT + sub;
+        }
+
+        /// @brief 某个数量级内最大可记录的值 (ns), 用作导出时的 le 边界
+        uint64_t magnitudeUpperBound(size_t magnitude) {
+            if (magnitude == 0)
+                return SUB_BUCKET_COUNT - 1;
+            return (uint64_t(2 * SUB_BUCKET_COUNT) << (magnitude - 1)) - 1;
+        }
+    }
+
+    /// @brief 获取全局注册表
+    Registry &Registry::instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    /// @brief 获取当前线程绑定的分片
+    Registry::Shard &Registry::localShard() {
+        thread_local size_t idx = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+        return shards[idx];
+    }
+
+    /// @brief 计数器加 n
+    void Registry::increment(Counter counter, uint64_t n) {
+        localShard().counters[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// @brief 记录一次耗时
+    void Registry::observe(Histogram histogram, std::chrono::nanoseconds value) {
+        size_t series = static_cast<size_t>(histogram);
+        uint64_t ns = value.count() > 0 ? value.count() : 0;
+        Shard &shard = localShard();
+        shard.buckets[series][bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        shard.sums[series].fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /// @brief 记录一次某种卡牌的结算耗时
+    void Registry::observe(CardType type, std::chrono::nanoseconds value) {
+        observe(static_cast<Histogram>(static_cast<size_t>(Histogram::DEAL_WITH_CARD) + type), value);
+    }
+
+    /// @brief 汇总所有分片, 读取计数器的值
+    uint64_t Registry::value(Counter counter) const {
+        uint64_t total = 0;
+        for (const auto &shard : shards)
+            total += shard.counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /// @brief 以 Prometheus 文本格式导出所有指标
+    std::string Registry::exposition() const {
+        std::ostringstream out;
+        for (size_t c = 0; c < static_cast<size_t>(Counter::COUNT); ++c) {
+            const auto &desc = CounterDescriptor[c];
+            out << "# HELP " << desc.name << ' ' << desc.help << '\n'
+                << "# TYPE " << desc.name << " counter\n"
+                << desc.name << ' ' << value(static_cast<Counter>(c)) << '\n';
+        }
+        size_t deal = static_cast<size_t>(Histogram::DEAL_WITH_CARD);
+        for (size_t h = 0; h < static_cast<size_t>(Histogram::COUNT); ++h) {
+            const auto &desc = HistogramDescriptor[h < deal ? h : deal];
+            std::string label = h < deal ? "" : std::string("card=\"") + CardLabel[h - deal] + "\",";
+            if (h <= deal)
+                out << "# HELP " << desc.name << ' ' << desc.help << '\n'
+                    << "# TYPE " << desc.name << " histogram\n";
+            // 汇总各分片
+            std::array<uint64_t, BUCKET_COUNT> merged{};
+            uint64_t sum = 0;
+            for (const auto &shard : shards) {
+                for (size_t b = 0; b < BUCKET_COUNT; ++b)
+                    merged[b] += shard.buckets[h][b].load(std::memory_order_relaxed);
+                sum += shard.sums[h].load(std::memory_order_relaxed);
+            }
+            // 只在每个数量级的末尾导出一个累计桶
+            uint64_t cumulative = 0;
+            for (size_t m = 0; m < MAGNITUDE_COUNT; ++m) {
+                for (size_t s = 0; s < SUB_BUCKET_COUNT; ++s)
+                    cumulative += merged[m * SUB_BUCKET_COUNT + s];
+                out << desc.name << "_bucket{" << label << "le=\""
+                    << static_cast<double>(magnitudeUpperBound(m)) / 1e9 << "\"} " << cumulative << '\n';
+            }
+            out << desc.name << "_bucket{" << label << "le=\"+Inf\"} " << cumulative << '\n';
+            if (label.empty()) {
+                out << desc.name << "_sum " << static_cast<double>(sum) / 1e9 << '\n'
+                    << desc.name << "_count " << cumulative << '\n';
+            } else {
+                label.pop_back();
+                out << desc.name << "_sum{" << label << "} " << static_cast<double>(sum) / 1e9 << '\n'
+                    << desc.name << "_count{" << label << "} " << cumulative << '\n';
+            }
+        }
+        return out.str();
+    }
+
+    ScopedTimer::~ScopedTimer() {
+        Registry::instance().observe(static_cast<Histogram>(series),
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now() - startTime));
+    }
+}
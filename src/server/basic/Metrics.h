@@ -0,0 +1,100 @@
+
+#ifndef KINGDOMCARD_METRICS_H
+#define KINGDOMCARD_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "basic/Card.h"
+
+namespace kc::metrics {
+    size_t const SHARD_COUNT = 8;             // 分片数, 每个线程固定写入其中一个
+    size_t const SUB_BUCKET_BITS = 3;         // 每个 2 的幂区间再细分为 8 份, 相对误差约 12.5%
+    size_t const SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    size_t const MAGNITUDE_COUNT = 40;        // 最大可记录约 2^40 ns ≈ 18 分钟
+    size_t const BUCKET_COUNT = MAGNITUDE_COUNT * SUB_BUCKET_COUNT;
+
+    enum class Counter {
+        MESSAGES_SENT,          // 发送成功的消息数
+        SEND_FAILURES,          // 发送失败的消息数
+        MESSAGES_RECEIVED,      // 接收成功的消息数
+        RECV_FAILURES,          // 接收失败的消息数
+        TURN_TIMEOUTS,          // 出牌超时的回合数
+        REACT_TIMEOUTS,         // 无人反应而结束的反应窗口数
+        INVALID_PLAYS,          // 非法出牌数
+        SNAPSHOT_FAILURES,      // 写入失败的对局快照数
+        MATCHES_FORMED,         // 匹配器组成的对局数
+        FRAMES_SENT,            // 发给玩家的帧数, 合并帧使它少于消息数
+        FRAMES_COMPRESSED,      // 以 zstd 压缩的合并帧数
+        COUNT
+    };
+
+    enum class Histogram {
+        SEND_COMMAND,           // util::sendCommand
+        RECV_COMMAND,           // util::recvCommand
+        WAIT_FOR_CARD,          // GameController::waitForCard
+        WAIT_FOR_REACT,         // GameController::waitForReact
+        BC_STATUS,              // GameController::bcStatus
+        SNAPSHOT,               // GameController::saveSnapshot
+        QUEUE_WAIT,             // 玩家在 Matchmaker 中的排队时长
+        DEAL_WITH_CARD,         // GameController::dealWithCard, 之后按卡牌类型依次排列
+        COUNT = DEAL_WITH_CARD + CARD_TYPE_COUNT
+    };
+
+    /// @brief 无锁指标注册表
+    /// @details 每个线程按首次使用顺序绑定到一个分片, 写入只做一次 relaxed 原子加法;
+    ///          读取时再把所有分片汇总, 因此只有导出指标的一方需要付出遍历的代价
+    class Registry {
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)> counters{};
+            std::array<std::array<std::atomic<uint64_t>, BUCKET_COUNT>,
+                       static_cast<size_t>(Histogram::COUNT)> buckets{};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Histogram::COUNT)> sums{};
+        };
+        std::array<Shard, SHARD_COUNT> shards;
+        std::atomic<size_t> nextShard{0};
+
+        Registry() = default;
+
+        Shard &localShard();
+
+    public:
+        Registry(const Registry &) = delete;
+
+        static Registry &instance();
+
+        void increment(Counter counter, uint64_t n = 1);
+
+        void observe(Histogram histogram, std::chrono::nanoseconds value);
+
+        void observe(CardType type, std::chrono::nanoseconds value);
+
+        [[nodiscard]] uint64_t value(Counter counter) const;
+
+        [[nodiscard]] std::string exposition() const;
+    };
+
+    /// @brief 作用域计时器, 析构时把经过的时间记录到直方图
+    class ScopedTimer {
+    private:
+        size_t series;
+        std::chrono::steady_clock::time_point startTime;
+    public:
+        explicit ScopedTimer(Histogram histogram)
+                : series(static_cast<size_t>(histogram)), startTime(std::chrono::steady_clock::now()) {}
+
+        explicit ScopedTimer(CardType type)
+                : series(static_cast<size_t>(Histogram::DEAL_WITH_CARD) + type),
+                  startTime(std::chrono::steady_clock::now()) {}
+
+        ScopedTimer(const ScopedTimer &) = delete;
+
+        ~ScopedTimer();
+    };
+
+    inline void increment(Counter counter, uint64_t n = 1) { Registry::instance().increment(counter, n); }
+}
+
+#endif //KINGDOMCARD_METRICS_H
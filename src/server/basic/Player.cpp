@@ -36,51 +36,34 @@ namespace kc {
             cmd.add_newcards()->CopyFrom(util::to_pb(*card));
             handCards.emplace_back(std::move(card));
         }
-        util::sendCommand(this, CommandType::NEW_CARD, cmd.SerializeAsString());
+        util::sendCommand(*this, CommandType::NEW_CARD, cmd);
     }
 
     /// @brief 弃掉多余生命点的牌, 并且通知玩家
-    std::vector<CardPtr> Player::discardMoreCard() {
+    /// @param keep 保留的手牌数, 即当前生命值
+    std::vector<CardPtr> Player::discardMoreCard(size_t keep) {
         DiscardCard cmd;
         std::vector<CardPtr> discardCards;
         // 洗牌
         std::shuffle(handCards.begin(), handCards.end(), std::default_random_engine(std::random_device()()));
-        int64_t cardNum = handCards.size() - health;
-        for (size_t i = 0; i < cardNum; ++i) {
+        int64_t cardNum = static_cast<int64_t>(handCards.size()) - static_cast<int64_t>(keep);
+        for (int64_t i = 0; i < cardNum; ++i) {
             spdlog::info("玩家 {} 弃掉了 id: {} type: {}", id, handCards[0]->id, CardName[handCards[0]->type]);
             cmd.add_discardedcards()->CopyFrom(util::to_pb(*handCards[0]));
             discardCards.emplace_back(std::move(handCards[0]));
             handCards.erase(handCards.begin());
         }
-        util::sendCommand(this, CommandType::DISCARD_CARD, cmd.SerializeAsString());
+        util::sendCommand(*this, CommandType::DISCARD_CARD, cmd);
         return std::move(discardCards);
     }
 
-    /// @brief 死亡归还牌组
-    std::vector<CardPtr> Player::die() {
+    /// @brief 交出全部手牌 (死亡时归还牌组)
+    std::vector<CardPtr> Player::takeAllCards() {
         std::vector<CardPtr> hc_temp = std::move(handCards);
         handCards.clear();
-        alive = false;
-        health = 0;
         return std::move(hc_temp);
     }
 
-    /// @brief 判断玩家是否有某种牌
-    bool Player::hasCard(CardType type) {
-        for (auto &card: handCards)
-            if (card->type == type)
-                return true;
-        return false;
-    }
-
-    /// @brief 判断玩家是否有某些牌中的一种
-    bool Player::hasCard(const std::set<CardType>& type) {
-        for (auto i : type)
-            if (hasCard(i))
-                return true;
-        return false;
-    }
-
     /// @brief 根据序号删除卡牌
     CardPtr Player::removeCardByNum(size_t num) {
         if (num >= handCards.size())
@@ -2,16 +2,23 @@
 #ifndef KINGDOMCARD_PLAYER_H
 #define KINGDOMCARD_PLAYER_H
 
+#include <array>
+#include <chrono>
+#include <optional>
 #include <vector>
 #include <memory>
 #include <set>
 #include <zmq.hpp>
 #include "basic/Card.h"
+#include "packed_wire.h"
 
 namespace kc {
     size_t const MAX_PLAYER_NUM = 10;
     size_t const MIN_PLAYER_NUM = 4;
-    size_t const ID_COUNT[7][4] = {
+    uint32_t const DEFAULT_RATING = 1500;   // 未上报分数的玩家按此分数匹配
+    /// @brief 按人数 (从 MIN_PLAYER_NUM 开始) 排列的主公、忠臣、反贼、内奸人数
+    typedef std::array<std::array<uint8_t, 4>, MAX_PLAYER_NUM - MIN_PLAYER_NUM + 1> IdentityCounts;
+    IdentityCounts const ID_COUNT = {{
             {1, 1, 1, 1},
             {1, 1, 2, 1},
             {1, 1, 3, 1},
@@ -19,7 +26,7 @@ namespace kc {
             {1, 2, 4, 1},
             {1, 3, 4, 1},
             {1, 3, 4, 2}
-    };
+    }};     // 默认身份分配, 房间规则可以另行配置
 
     std::string const PlayerIdentityName[5] = {
             "未知",
@@ -41,36 +48,33 @@ namespace kc {
 
     typedef std::shared_ptr<Player> PlayerPtr;
 
+    /// @brief 玩家的冷数据: 连接与手牌实体
+    /// @details 体力、身份、存活等对局热数据按座位保存在 GameController 的 PlayerTable 中;
+    ///          同一时刻只有一个线程使用玩家: 等待时由 GameServer 在自己的锁内移交, 入座后只由房间线程使用
     class Player {
     private:
-        uint16_t static idCounter;
-        PlayerIdentity identity;
-        bool alive;
-        uint16_t health;
-        uint16_t maxHealth;
+        uint32_t static idCounter;
         std::vector<CardPtr> handCards;
 
     public:
-        uint16_t const id;
+        uint32_t const id;
+        uint64_t sessionToken = 0;      // 连接时下发, 服务器重启后凭它找回原来的座位
+        uint32_t rating = DEFAULT_RATING;   // 匹配用的分数
+        std::optional<std::chrono::microseconds> clockOffset;  // 客户端单调时钟减去服务器单调时钟, 连接时估计
+        wire::Format wireFormat = wire::PROTOBUF;   // 连接时协商的编码, 之后这条连接上的消息都使用它
+        bool batchFrames = false;       // 连接时协商, 客户端能拆开合并帧
+        bool zstdFrames = false;        // 连接时协商, 较大的合并帧以 zstd 压缩
+        bool isHolding = false;         // 发出的消息先攒在 outbox 中, 见 util::holdOutput
+        std::string outbox;             // 攒下的消息, 每条前有 uint32 长度, 即合并帧的消息区
+        uint16_t outboxCount = 0;
         zmq::socket_t socket;
-        std::mutex mtx;
-
-        Player(uint16_t id, zmq::socket_t socket)
-                : identity(UNKNOWN), alive(true), health(4), maxHealth(4), id(id), socket(std::move(socket)) {}
-
-        [[nodiscard]] bool isAlive() const { return alive; }
-
-        [[nodiscard]] uint16_t getHealth() const { return health; }
 
-        [[nodiscard]] uint16_t getMaxHealth() const { return maxHealth; }
+        Player(uint32_t id, zmq::socket_t socket) : id(id), socket(std::move(socket)) {}
 
-        [[nodiscard]] PlayerIdentity getIdentity() const { return identity; }
+        virtual ~Player() = default;
 
-        void setHealth(uint16_t n_health) { health = n_health; }
-
-        void setMaxHealth(uint16_t max_health) { maxHealth = max_health; }
-
-        void setIdentity(PlayerIdentity n_identity) { identity = n_identity; }
+        /// @brief 是否为服务器内置的机器人, 机器人没有套接字, 由 GameController 直接询问决策
+        [[nodiscard]] virtual bool isBot() const { return false; }
 
         [[nodiscard]] size_t getCardCount() const { return handCards.size(); }
 
@@ -86,13 +90,9 @@ namespace kc {
 
         [[nodiscard]] CardPtr removeCardByNum(size_t num);
 
-        [[nodiscard]] std::vector<CardPtr> discardMoreCard();
-
-        [[nodiscard]] std::vector<CardPtr> die();
-
-        [[nodiscard]] bool hasCard(CardType type);
+        [[nodiscard]] std::vector<CardPtr> discardMoreCard(size_t keep);
 
-        [[nodiscard]] bool hasCard(const std::set<CardType>& type);
+        [[nodiscard]] std::vector<CardPtr> takeAllCards();
     };
 }
 
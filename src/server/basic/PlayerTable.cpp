@@ -0,0 +1,134 @@
+
+#include "PlayerTable.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace kc {
+    /// @brief 按玩家列表重建座位表, 所有玩家满血存活, 手牌为空
+    void PlayerTable::reset(const std::vector<PlayerPtr> &players) {
+        if (players.size() > MAX_PLAYER_NUM)
+            throw std::invalid_argument("玩家数量不合法");
+        size = players.size();
+        aliveCount = size;
+        slotSeat.fill(EMPTY_SLOT);
+        for (size_t seat = 0; seat < size; ++seat) {
+            id[seat] = players[seat]->id;
+            hp[seat] = DEFAULT_HEALTH;
+            maxHp[seat] = DEFAULT_HEALTH;
+            alive[seat] = 1;
+            identity[seat] = UNKNOWN;
+            cardCount[seat] = 0;
+            typeCount[seat].fill(0);
+            prevAlive[seat] = (seat + size - 1) % size;
+            nextAlive[seat] = (seat + 1) % size;
+            aliveIds[seat] = id[seat];
+            size_t slot = id[seat] & (SEAT_MAP_SIZE - 1);
+            while (slotSeat[slot] != EMPTY_SLOT)
+                slot = (slot + 1) & (SEAT_MAP_SIZE - 1);
+            slotId[slot] = id[seat];
+            slotSeat[slot] = seat;
+        }
+    }
+
+    /// @brief 根据玩家 id 查找座位
+    /// @return 座位, 不存在时为 NO_SEAT
+    size_t PlayerTable::seatOf(size_t player_id) const {
+        for (size_t slot = player_id & (SEAT_MAP_SIZE - 1), n = 0; n < SEAT_MAP_SIZE;
+             slot = (slot + 1) & (SEAT_MAP_SIZE - 1), ++n) {
+            if (slotSeat[slot] == EMPTY_SLOT)
+                return NO_SEAT;
+            if (slotId[slot] == player_id)
+                return slotSeat[slot];
+        }
+        return NO_SEAT;
+    }
+
+    /// @brief 判断座位上的玩家是否有掩码中的某种牌
+    /// @param mask 按 CardType 置位的掩码, 见 cardMask
+    bool PlayerTable::hasCard(size_t seat, uint32_t mask) const {
+        for (size_t type = 0; type < CARD_TYPE_COUNT; ++type)
+            if ((mask & (1u << type)) && typeCount[seat][type] > 0)
+                return true;
+        return false;
+    }
+
+    /// @brief 登记本局的整副牌, 要求 id 连续 (见 Card::generateDeck), 所有牌都在牌堆中
+    void PlayerTable::resetDeck(const std::vector<CardPtr> &deck) {
+        cardOwner.fill(IN_DECK);
+        deckSize = 0;
+        if (deck.empty())
+            return;
+        if (deck.size() > DECK_CARD_COUNT)
+            throw std::invalid_argument("牌的数量超过上限");
+        cardIdBase = deck.front()->id;
+        deckSize = deck.size();
+        for (const auto &card : deck) {
+            size_t idx = cardIndex(card->id);
+            if (idx == NO_CARD)
+                throw std::invalid_argument("牌的 id 不连续");
+            cardType[idx] = card->type;
+        }
+    }
+
+    /// @brief 牌在整副牌中的下标
+    /// @return 下标, 不是本局的牌时为 NO_CARD
+    size_t PlayerTable::cardIndex(size_t card_id) const {
+        if (card_id > UINT16_MAX)
+            return NO_CARD;
+        auto idx = static_cast<uint16_t>(card_id - cardIdBase);
+        return idx < deckSize ? idx : NO_CARD;
+    }
+
+    void PlayerTable::addCard(size_t seat, const Card &card) {
+        ++typeCount[seat][card.type];
+        ++cardCount[seat];
+        size_t idx = cardIndex(card.id);
+        if (idx != NO_CARD)
+            cardOwner[idx] = seat;
+    }
+
+    void PlayerTable::removeCard(size_t seat, const Card &card) {
+        --typeCount[seat][card.type];
+        --cardCount[seat];
+        size_t idx = cardIndex(card.id);
+        if (idx != NO_CARD)
+            cardOwner[idx] = IN_DECK;
+    }
+
+    void PlayerTable::clearHand(size_t seat) {
+        typeCount[seat].fill(0);
+        cardCount[seat] = 0;
+        for (auto &owner : cardOwner)
+            if (owner == seat)
+                owner = IN_DECK;
+    }
+
+    /// @brief 标记座位死亡, 从存活环与存活列表中摘除
+    void PlayerTable::kill(size_t seat) {
+        if (!alive[seat])
+            return;
+        alive[seat] = 0;
+        nextAlive[prevAlive[seat]] = nextAlive[seat];
+        prevAlive[nextAlive[seat]] = prevAlive[seat];
+        size_t *pos = std::find(aliveIds.begin(), aliveIds.begin() + aliveCount, id[seat]);
+        std::move(pos + 1, aliveIds.begin() + aliveCount, pos);
+        --aliveCount;
+    }
+
+    /// @brief 顺时针方向下一个存活座位
+    /// @details 死亡座位的 nextAlive 可能已经过期, 但总是顺时针前进, 沿链最多走 size 步
+    /// @return 座位, 没有存活座位时为 NO_SEAT
+    size_t PlayerTable::nextAliveSeat(size_t seat) const {
+        size_t next = nextAlive[seat];
+        for (size_t step = 0; step < size; ++step, next = nextAlive[next])
+            if (alive[next])
+                return next;
+        return NO_SEAT;
+    }
+
+    /// @brief 判断两个存活座位是否相邻
+    bool PlayerTable::isNeighbor(size_t seat, size_t other) const {
+        return other != seat && (prevAlive[seat] == other || nextAlive[seat] == other);
+    }
+}
@@ -0,0 +1,106 @@
+
+#ifndef KINGDOMCARD_PLAYERTABLE_H
+#define KINGDOMCARD_PLAYERTABLE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "basic/Card.h"
+#include "basic/Player.h"
+
+namespace kc {
+    size_t const NO_SEAT = -1;
+    size_t const NO_CARD = -1;
+    size_t const SEAT_MAP_SIZE = 32;      // id -> 座位的开放寻址表大小, 须为 2 的幂且远大于 MAX_PLAYER_NUM
+    uint16_t const DEFAULT_HEALTH = 4;
+    size_t const INITIAL_HAND = 4;        // 默认起始手牌数
+    size_t const DRAW_PER_TURN = 2;       // 默认每回合摸牌数
+
+    /// @brief 只读的玩家 id 区间, 不持有数据, 用于避免传参时构造 vector
+    class IdSpan {
+    private:
+        const size_t *first;
+        size_t count;
+
+    public:
+        IdSpan(const size_t *first, size_t count) : first(first), count(count) {}
+
+        IdSpan(const size_t &id) : first(&id), count(1) {}     // 单个玩家
+
+        IdSpan(const std::vector<size_t> &ids) : first(ids.data()), count(ids.size()) {}
+
+        [[nodiscard]] const size_t *begin() const { return first; }
+
+        [[nodiscard]] const size_t *end() const { return first + count; }
+
+        [[nodiscard]] size_t size() const { return count; }
+
+        size_t operator[](size_t idx) const { return first[idx]; }
+    };
+
+    /// @brief 对局中的玩家热数据, 按座位以 SoA 排列
+    /// @details 座位即玩家在 GameController::players 中的下标 (按 id 排序),
+    ///          规则结算只读写这里的定长数组, 不再经由 shared_ptr 访问 Player;
+    ///          typeCount 是手牌按牌型的计数, 与 Player 持有的手牌实体同步维护;
+    ///          存活座位另外组成一个双向环, 死亡时摘除, 相邻与下一回合的查询都是 O(1);
+    ///          整副牌的 id 连续, cardOwner 记录每张牌所在的座位, 出牌校验时 O(1) 判断归属
+    class PlayerTable {
+    private:
+        static constexpr uint8_t EMPTY_SLOT = 0xff;
+        uint16_t cardIdBase = 0;
+        size_t deckSize = 0;
+        std::array<uint32_t, SEAT_MAP_SIZE> slotId{};
+        std::array<uint8_t, SEAT_MAP_SIZE> slotSeat{};
+
+    public:
+        size_t size = 0;
+        std::array<uint32_t, MAX_PLAYER_NUM> id{};
+        std::array<uint16_t, MAX_PLAYER_NUM> hp{};
+        std::array<uint16_t, MAX_PLAYER_NUM> maxHp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> alive{};
+        std::array<PlayerIdentity, MAX_PLAYER_NUM> identity{};
+        std::array<uint8_t, MAX_PLAYER_NUM> cardCount{};
+        std::array<std::array<uint8_t, CARD_TYPE_COUNT>, MAX_PLAYER_NUM> typeCount{};
+        std::array<uint8_t, MAX_PLAYER_NUM> prevAlive{};    // 逆时针方向上一个存活座位
+        std::array<uint8_t, MAX_PLAYER_NUM> nextAlive{};    // 顺时针方向下一个存活座位, 死亡座位保留摘除时的值
+        size_t aliveCount = 0;
+        std::array<size_t, MAX_PLAYER_NUM> aliveIds{};      // 存活玩家 id, 按座位排列
+        std::array<uint8_t, DECK_CARD_COUNT> cardOwner{};   // 按牌的下标记录所在座位, 不在手牌中为 IN_DECK
+        std::array<CardType, DECK_CARD_COUNT> cardType{};
+        uint8_t drawPerTurn = DRAW_PER_TURN;                // 本局每回合摸牌数, 供机器人推演
+
+        static constexpr uint8_t IN_DECK = 0xff;
+
+        void reset(const std::vector<PlayerPtr> &players);
+
+        [[nodiscard]] size_t seatOf(size_t player_id) const;
+
+        [[nodiscard]] bool hasCard(size_t seat, CardType type) const { return typeCount[seat][type] > 0; }
+
+        [[nodiscard]] bool hasCard(size_t seat, uint32_t mask) const;
+
+        void resetDeck(const std::vector<CardPtr> &deck);
+
+        [[nodiscard]] size_t cardIndex(size_t card_id) const;
+
+        [[nodiscard]] uint16_t firstCardId() const { return cardIdBase; }
+
+        [[nodiscard]] size_t deckCardCount() const { return deckSize; }
+
+        void addCard(size_t seat, const Card &card);
+
+        void removeCard(size_t seat, const Card &card);
+
+        void clearHand(size_t seat);
+
+        void kill(size_t seat);
+
+        [[nodiscard]] size_t nextAliveSeat(size_t seat) const;
+
+        [[nodiscard]] bool isNeighbor(size_t seat, size_t other) const;
+
+        [[nodiscard]] IdSpan alivePlayers() const { return {aliveIds.data(), aliveCount}; }
+    };
+}
+
+#endif //KINGDOMCARD_PLAYERTABLE_H
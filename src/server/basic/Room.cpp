@@ -0,0 +1,66 @@
+
+#include "Room.h"
+
+#include <memory>
+#include <spdlog/spdlog.h>
+#include "basic/GameController.h"
+#include "basic/Shard.h"
+#include "basic/SpectatorFeed.h"
+#include "basic/Utility.h"
+
+namespace kc {
+    Room::Room(uint64_t id, std::vector<PlayerPtr> players, RoomRules rules)
+            : id(id), players(std::move(players)), rules(std::move(rules)) {
+        for (const auto &player : this->players)
+            ids.push_back(player->id);
+    }
+
+    /// @brief 等待对局结束
+    Room::~Room() {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    /// @brief 在新线程中开始对局
+    /// @param snapshots 快照写入器, 为空时不保存快照
+    /// @param spectator_context 与 SpectatorHub 共享的 ZeroMQ 上下文, 为空时不可观战
+    /// @param resumed 有值时从该快照继续对局
+    /// @param cpu 房间线程绑定的核心, 为 -1 时不绑定
+    void Room::start(SnapshotWriter *snapshots, zmq::context_t *spectator_context,
+                     std::optional<MatchSnapshot> resumed, int cpu) {
+        thread = std::thread(&Room::run, this, snapshots, spectator_context, std::move(resumed), cpu);
+    }
+
+    void Room::run(SnapshotWriter *snapshots, zmq::context_t *spectator_context,
+                   std::optional<MatchSnapshot> resumed, int cpu) {
+        pinCurrentThread(cpu);
+        // 观战套接字只在本线程中使用
+        std::unique_ptr<SpectatorFeed> feed;
+        if (spectator_context != nullptr) {
+            feed = std::make_unique<SpectatorFeed>(*spectator_context, id);
+            spdlog::info("对局 {} 可观战", id);
+        }
+        try {
+            // 在房间线程中估计客户端时钟偏移, 不占用登入线程; 之后的 YOUR_TURN 以客户端时钟下发截止时刻, 失败不影响对局
+            util::syncClocks(players);
+            GameController controller(players);
+            controller.setSnapshotWriter(snapshots, id);
+            controller.setSpectatorFeed(feed.get());
+            controller.setRules(rules);
+            controller.setMatchStatus(&status);
+            if (resumed.has_value()) {
+                spdlog::info("继续对局 {}", id);
+                controller.resume(resumed.value());
+            } else {
+                spdlog::info("对局 {} 开始, 玩家数: {}, 规则: {}", id, players.size(), rules.name);
+                controller.start();
+            }
+        } catch (std::exception &e) {
+            spdlog::error("对局 {} 异常结束: {}", id, e.what());
+        }
+        feed.reset();
+        for (auto &player : players)
+            player->socket.close();
+        finished = true;
+    }
+}
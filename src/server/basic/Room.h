@@ -0,0 +1,68 @@
+
+#ifndef KINGDOMCARD_ROOM_H
+#define KINGDOMCARD_ROOM_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include "basic/GameController.h"
+#include "basic/Player.h"
+#include "basic/ServerConfig.h"
+#include "basic/Snapshot.h"
+#include "basic/SnapshotWriter.h"
+
+namespace kc {
+    /// @brief 一张正在进行的桌子, 在自己的线程中运行一局 GameController
+    /// @details 桌上的玩家在开局时移交给房间, 之后只由房间线程使用, 对局结束后由房间关闭他们的套接字;
+    ///          对局进度经 MatchStatus 公开, 其他线程读取时不与游戏线程争用
+    class Room {
+    private:
+        uint64_t id;
+        std::vector<PlayerPtr> players;     // 下标即座位, 由 GameController 排序
+        std::vector<uint32_t> ids;          // 开局时的玩家 id, 供其他线程读取
+        RoomRules rules;
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        MatchStatus status;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+
+        void run(SnapshotWriter *snapshots, zmq::context_t *spectator_context,
+                 std::optional<MatchSnapshot> resumed, int cpu);
+
+    public:
+        Room(uint64_t id, std::vector<PlayerPtr> players, RoomRules rules);
+
+        Room(const Room &) = delete;
+
+        ~Room();
+
+        void start(SnapshotWriter *snapshots, zmq::context_t *spectator_context,
+                   std::optional<MatchSnapshot> resumed = std::nullopt, int cpu = -1);
+
+        [[nodiscard]] uint64_t getId() const { return id; }
+
+        [[nodiscard]] size_t playerCount() const { return ids.size(); }
+
+        [[nodiscard]] const RoomRules &getRules() const { return rules; }
+
+        [[nodiscard]] const MatchStatus &getStatus() const { return status; }
+
+        [[nodiscard]] std::chrono::steady_clock::duration elapsed() const {
+            return std::chrono::steady_clock::now() - startTime;
+        }
+
+        [[nodiscard]] const std::vector<uint32_t> &playerIds() const { return ids; }
+
+        void requestStop() { status.abortRequested = true; }
+
+        [[nodiscard]] bool isFinished() const { return finished; }
+    };
+
+    typedef std::vector<std::shared_ptr<Room>> RoomList;
+}
+
+#endif //KINGDOMCARD_ROOM_H
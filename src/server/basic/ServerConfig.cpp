@@ -0,0 +1,104 @@
+
+#include "ServerConfig.h"
+
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <google/protobuf/text_format.h>
+#include "server_config.pb.h"
+
+namespace kc {
+    namespace {
+        RoomRules const DEFAULT_RULES{};
+
+        /// @brief 转换一套房间规则并检查取值, 不合法时抛出 std::runtime_error
+        RoomRules toRules(const RoomRules_pb &room, size_t index) {
+            RoomRules rules;
+            rules.name = room.name().empty() ? "#" + std::to_string(index + 1) : room.name();
+            auto fail = [&rules](const std::string &what) {
+                throw std::runtime_error("房间规则 " + rules.name + ": " + what);
+            };
+            if (room.min_players() != 0)
+                rules.minPlayers = room.min_players();
+            if (room.max_players() != 0)
+                rules.maxPlayers = room.max_players();
+            if (rules.minPlayers < MIN_PLAYER_NUM || rules.maxPlayers > MAX_PLAYER_NUM
+                || rules.minPlayers > rules.maxPlayers)
+                fail("人数范围不合法");
+            if (room.turn_time_limit_ms() != 0)
+                rules.turnTimeLimit = std::chrono::milliseconds(room.turn_time_limit_ms());
+            if (room.react_time_limit_ms() != 0)
+                rules.reactTimeLimit = std::chrono::milliseconds(room.react_time_limit_ms());
+            if (room.card_count_size() != 0) {
+                if (room.card_count_size() != CARD_TYPE_COUNT)
+                    fail("card_count 须按顺序列出全部 " + std::to_string(CARD_TYPE_COUNT) + " 种牌");
+                for (size_t t = 0; t < CARD_TYPE_COUNT; ++t) {
+                    if (room.card_count(static_cast<int>(t)) > DECK_CARD_COUNT)
+                        fail(CardName[t] + " 的张数过多");
+                    rules.cardCount[t] = room.card_count(static_cast<int>(t));
+                }
+            }
+            if (rules.deckSize() > DECK_CARD_COUNT)
+                fail("整副牌不能超过 " + std::to_string(DECK_CARD_COUNT) + " 张");
+            for (const auto &idt : room.identity_count()) {
+                if (idt.players() < MIN_PLAYER_NUM || idt.players() > MAX_PLAYER_NUM)
+                    fail("identity_count 的人数不合法");
+                // 恰好一名主公, 且至少一名反贼, 否则开局即分出胜负
+                if (idt.lord() != 1 || idt.rebel() == 0
+                    || idt.lord() + idt.minister() + idt.rebel() + idt.spy() != idt.players())
+                    fail(std::to_string(idt.players()) + " 人的身份分配不合法");
+                rules.identityCount[idt.players() - MIN_PLAYER_NUM] = {
+                        static_cast<uint8_t>(idt.lord()), static_cast<uint8_t>(idt.minister()),
+                        static_cast<uint8_t>(idt.rebel()), static_cast<uint8_t>(idt.spy())};
+            }
+            if (room.initial_hand() != 0)
+                rules.initialHand = room.initial_hand();
+            if (room.draw_per_turn() != 0)
+                rules.drawPerTurn = room.draw_per_turn();
+            if (rules.initialHand * rules.maxPlayers > rules.deckSize())
+                fail("牌不够发起始手牌");
+            if (rules.drawPerTurn > DECK_CARD_COUNT)
+                fail("每回合摸牌数过多");
+            return rules;
+        }
+    }
+
+    size_t RoomRules::deckSize() const {
+        return std::accumulate(cardCount.begin(), cardCount.end(), size_t(0));
+    }
+
+    /// @brief 查找某个人数的桌子使用的规则
+    /// @return 第一套人数范围合适的规则, 都不合适时为默认规则
+    const RoomRules &ServerConfig::rulesFor(size_t player_num) const {
+        for (const auto &rules : rooms)
+            if (rules.minPlayers <= player_num && player_num <= rules.maxPlayers)
+                return rules;
+        return DEFAULT_RULES;
+    }
+
+    /// @brief 读取 protobuf 文本格式的配置文件, 见 server_config.proto
+    /// @param path 配置文件路径
+    /// @throw std::runtime_error 文件无法读取或取值不合法
+    ServerConfig ServerConfig::load(const std::string &path) {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("无法打开配置文件 " + path);
+        std::stringstream text;
+        text << file.rdbuf();
+        ServerConfig_pb config_pb;
+        if (!google::protobuf::TextFormat::ParseFromString(text.str(), &config_pb))
+            throw std::runtime_error("配置文件 " + path + " 格式错误");
+        ServerConfig config;
+        if (config_pb.port() != 0) {
+            if (config_pb.port() > UINT16_MAX)
+                throw std::runtime_error("端口号不合法");
+            config.port = static_cast<uint16_t>(config_pb.port());
+        }
+        config.shards = config_pb.shards();
+        config.zstdDictionary = config_pb.zstd_dictionary();
+        for (int i = 0; i < config_pb.room_size(); ++i)
+            config.rooms.emplace_back(toRules(config_pb.room(i), i));
+        return config;
+    }
+}
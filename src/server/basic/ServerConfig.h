@@ -0,0 +1,45 @@
+
+#ifndef KINGDOMCARD_SERVERCONFIG_H
+#define KINGDOMCARD_SERVERCONFIG_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "basic/Card.h"
+#include "basic/Player.h"
+#include "basic/PlayerTable.h"
+
+namespace kc {
+    const std::chrono::microseconds TURN_TIME_LIMIT = std::chrono::seconds(30);
+    const std::chrono::microseconds REACT_TIME_LIMIT = std::chrono::seconds(5);
+    uint16_t const DEFAULT_PORT = 13364;
+
+    /// @brief 一类房间的规则与时限, 开局时拷贝一份, 重新加载配置不影响进行中的对局
+    struct RoomRules {
+        std::string name = "standard";
+        size_t minPlayers = MIN_PLAYER_NUM;
+        size_t maxPlayers = MAX_PLAYER_NUM;
+        std::chrono::microseconds turnTimeLimit = TURN_TIME_LIMIT;
+        std::chrono::microseconds reactTimeLimit = REACT_TIME_LIMIT;
+        CardCounts cardCount = CARD_COUNT;
+        IdentityCounts identityCount = ID_COUNT;
+        size_t initialHand = INITIAL_HAND;
+        size_t drawPerTurn = DRAW_PER_TURN;
+
+        [[nodiscard]] size_t deckSize() const;
+    };
+
+    /// @brief kc_server 的配置
+    struct ServerConfig {
+        uint16_t port = DEFAULT_PORT;
+        size_t shards = 0;                  // 为 0 时每个可用核心一个分片
+        std::string zstdDictionary;         // 为空时压缩合并帧不使用字典
+        std::vector<RoomRules> rooms;       // 为空时所有桌子使用默认规则
+
+        [[nodiscard]] const RoomRules &rulesFor(size_t player_num) const;
+
+        [[nodiscard]] static ServerConfig load(const std::string &path);
+    };
+}
+
+#endif //KINGDOMCARD_SERVERCONFIG_H
@@ -0,0 +1,108 @@
+
+#include "Shard.h"
+
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+    /// @brief 进程启动时允许使用的核心, 在任何线程被绑定之前取得
+    const cpu_set_t processCpus = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0)
+            CPU_ZERO(&set);
+        return set;
+    }();
+}
+
+namespace kc {
+    /// @brief 把当前线程绑定到一个核心, 之后创建的线程继承该绑定
+    /// @param cpu 核心编号, 为 -1 时不做任何事
+    void pinCurrentThread(int cpu) {
+        if (cpu < 0)
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+            spdlog::warn("无法绑定到核心 {}: 错误码 {}", cpu, err);
+    }
+
+    /// @brief 让当前线程可以使用进程允许的全部核心, 供房间线程创建的辅助线程 (如 ISMCTS 的搜索线程) 解除继承的绑定
+    void unpinCurrentThread() {
+        if (CPU_COUNT(&processCpus) == 0)
+            return;
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(processCpus), &processCpus);
+        if (err != 0)
+            spdlog::warn("无法解除核心绑定: 错误码 {}", err);
+    }
+
+    /// @brief 本进程允许使用的核心, 受 taskset 等设置的限制
+    std::vector<int> Shard::availableCpus() {
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &processCpus))
+                cpus.push_back(c);
+        return cpus;
+    }
+
+    /// @brief 启动分片线程
+    /// @param index 分片编号
+    /// @param cpu 绑定的核心, 为 -1 时不绑定
+    Shard::Shard(size_t index, int cpu) : index(index), cpu(cpu) {
+        thread = std::thread(&Shard::run, this);
+    }
+
+    /// @brief 等待已分配的房间全部结束
+    Shard::~Shard() {
+        isRunning = false;
+        if (thread.joinable())
+            thread.join();
+    }
+
+    /// @brief 把一张新桌子交给分片, 同一时刻只能有一个线程调用
+    /// @return 信箱已满时为 false, assignment 保持不变
+    bool Shard::submit(RoomAssignment &&assignment) {
+        if (!mailbox.push(std::move(assignment)))
+            return false;
+        ++load;
+        return true;
+    }
+
+    /// @brief 取得本分片房间列表的快照, 其中可能有刚结束而尚未回收的房间
+    std::shared_ptr<const RoomList> Shard::roomSnapshot() const {
+        return std::atomic_load(&rooms);
+    }
+
+    void Shard::run() {
+        pinCurrentThread(cpu);
+        RoomList owned;
+        while (isRunning || !owned.empty() || !mailbox.empty()) {
+            bool changed = false;
+            while (std::optional<RoomAssignment> assignment = mailbox.pop()) {
+                assignment->room->start(assignment->snapshots, assignment->spectatorContext,
+                                        std::move(assignment->resumed), cpu);
+                owned.emplace_back(std::move(assignment->room));
+                changed = true;
+            }
+            // 回收已结束的房间, 其他线程仍持有快照时由最后释放的一方析构
+            size_t playing = owned.size();
+            owned.erase(std::remove_if(owned.begin(), owned.end(),
+                                       [](const std::shared_ptr<Room> &r) { return r->isFinished(); }),
+                        owned.end());
+            if (owned.size() != playing) {
+                load -= playing - owned.size();
+                changed = true;
+            }
+            if (changed) {
+                std::atomic_store(&rooms, std::make_shared<const RoomList>(owned));
+                spdlog::debug("分片 {} 的对局数: {}", index, owned.size());
+            }
+            std::this_thread::sleep_for(SHARD_POLL);
+        }
+        std::atomic_store(&rooms, std::make_shared<const RoomList>());
+    }
+}
@@ -0,0 +1,70 @@
+
+#ifndef KINGDOMCARD_SHARD_H
+#define KINGDOMCARD_SHARD_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include "basic/Room.h"
+#include "basic/Snapshot.h"
+#include "basic/SnapshotWriter.h"
+#include "basic/SpscQueue.h"
+
+namespace kc {
+    std::chrono::milliseconds const SHARD_POLL(10);     // 分片检查信箱与回收房间的间隔
+    size_t const SHARD_MAILBOX_SIZE = 256;
+
+    /// @brief 交给分片的一张新桌子
+    struct RoomAssignment {
+        std::shared_ptr<Room> room;
+        SnapshotWriter *snapshots = nullptr;
+        zmq::context_t *spectatorContext = nullptr;
+        std::optional<MatchSnapshot> resumed;
+    };
+
+    /// @brief 绑定到一个 CPU 核心的房间执行器
+    /// @details 每个房间只属于一个分片: 分片线程从 SPSC 信箱取出新房间, 在同一核心上开始对局,
+    ///          并在对局结束后回收; 房间列表只由分片线程替换, 其他线程读取快照时不加锁.
+    ///          玩家入座后只由房间线程使用, 不同分片之间不共享任何可变状态
+    class Shard {
+    private:
+        size_t index;
+        int cpu;                                    // 绑定的核心, 为 -1 时不绑定
+        SpscQueue<RoomAssignment, SHARD_MAILBOX_SIZE> mailbox;  // 生产者须在外部串行化
+        std::shared_ptr<const RoomList> rooms = std::make_shared<const RoomList>();
+        std::atomic<size_t> load{0};                // 已分配而未结束的房间数
+        std::atomic<bool> isRunning{true};
+        std::thread thread;
+
+        void run();
+
+    public:
+        Shard(size_t index, int cpu);
+
+        Shard(const Shard &) = delete;
+
+        ~Shard();
+
+        bool submit(RoomAssignment &&assignment);
+
+        [[nodiscard]] std::shared_ptr<const RoomList> roomSnapshot() const;
+
+        [[nodiscard]] size_t getIndex() const { return index; }
+
+        [[nodiscard]] int getCpu() const { return cpu; }
+
+        [[nodiscard]] size_t getLoad() const { return load; }
+
+        [[nodiscard]] static std::vector<int> availableCpus();
+    };
+
+    void pinCurrentThread(int cpu);
+
+    void unpinCurrentThread();
+}
+
+#endif //KINGDOMCARD_SHARD_H
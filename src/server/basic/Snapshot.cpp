@@ -0,0 +1,67 @@
+
+#include "Snapshot.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include "basic/PlayerTable.h"
+
+namespace kc {
+    namespace {
+        /// @brief checksum 之前所有字节的 64 位 FNV-1a
+        uint64_t checksumOf(const MatchSnapshot &snapshot) {
+            const auto *bytes = reinterpret_cast<const unsigned char *>(&snapshot);
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < offsetof(MatchSnapshot, checksum); ++i) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+    }
+
+    /// @brief 填写校验和, 写盘前调用
+    void seal(MatchSnapshot &snapshot) {
+        snapshot.checksum = checksumOf(snapshot);
+    }
+
+    /// @brief 检查魔数、版本、校验和以及各字段的取值范围
+    bool isValid(const MatchSnapshot &snapshot) {
+        if (snapshot.magic != SNAPSHOT_MAGIC || snapshot.version != SNAPSHOT_VERSION
+            || snapshot.checksum != checksumOf(snapshot))
+            return false;
+        size_t deck_size = std::accumulate(snapshot.cardCount.begin(), snapshot.cardCount.end(), size_t(0));
+        if (snapshot.playerCount < MIN_PLAYER_NUM || snapshot.playerCount > MAX_PLAYER_NUM
+            || snapshot.currSeat >= snapshot.playerCount || deck_size > DECK_CARD_COUNT
+            || snapshot.deckCount > deck_size)
+            return false;
+        // 每张牌恰好在牌堆或某个座位的手牌中出现一次
+        std::array<uint8_t, DECK_CARD_COUNT> seen{};
+        for (size_t i = 0; i < snapshot.deckCount; ++i) {
+            uint8_t idx = snapshot.deck[i];
+            if (idx >= deck_size || seen[idx]++ || snapshot.cardOwner[idx] != PlayerTable::IN_DECK)
+                return false;
+        }
+        for (size_t idx = 0; idx < deck_size; ++idx)
+            if (!seen[idx] && snapshot.cardOwner[idx] >= snapshot.playerCount)
+                return false;
+        return true;
+    }
+
+    /// @brief 从文件读取快照, 文件不存在或内容无效时返回空
+    std::optional<MatchSnapshot> loadSnapshot(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return std::nullopt;
+        MatchSnapshot snapshot;
+        char buffer[sizeof(MatchSnapshot) + 1];
+        file.read(buffer, sizeof(buffer));
+        if (file.gcount() != sizeof(MatchSnapshot))
+            return std::nullopt;
+        std::memcpy(&snapshot, buffer, sizeof(MatchSnapshot));
+        if (!isValid(snapshot))
+            return std::nullopt;
+        return snapshot;
+    }
+}
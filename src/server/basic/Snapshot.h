@@ -0,0 +1,56 @@
+
+#ifndef KINGDOMCARD_SNAPSHOT_H
+#define KINGDOMCARD_SNAPSHOT_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include "basic/Card.h"
+#include "basic/Player.h"
+
+namespace kc {
+    uint32_t const SNAPSHOT_MAGIC = 0x5353434b;     // "KCSS"
+    uint16_t const SNAPSHOT_VERSION = 3;
+
+    /// @brief 对局在回合边界的完整状态, 用于 kc_server 重启后恢复
+    /// @details 定长且没有填充字节, 编码只是逐字段拷贝, 写盘时直接按字节写出;
+    ///          手牌由 cardOwner 还原, 牌的类型由 cardIdBase 与 cardCount 按 Card::generateDeck 的顺序推出
+    struct MatchSnapshot {
+        uint32_t magic = SNAPSHOT_MAGIC;
+        uint16_t version = SNAPSHOT_VERSION;
+        uint16_t playerCount = 0;
+        uint64_t matchId = 0;
+        uint32_t turn = 0;                                  // 已经开始的回合数
+        uint32_t lordId = 0;
+        uint16_t currSeat = 0;                              // 即将开始回合的座位
+        uint16_t cardIdBase = 0;
+        uint16_t deckCount = 0;
+        uint16_t reservedId = 0;                            // 对齐 id
+        std::array<uint32_t, MAX_PLAYER_NUM> id{};
+        std::array<uint16_t, MAX_PLAYER_NUM> hp{};
+        std::array<uint16_t, MAX_PLAYER_NUM> maxHp{};
+        std::array<uint8_t, MAX_PLAYER_NUM> alive{};
+        std::array<uint8_t, MAX_PLAYER_NUM> identity{};
+        std::array<uint8_t, MAX_PLAYER_NUM> isBot{};
+        CardCounts cardCount{};                             // 本局牌组, 见 RoomRules
+        uint8_t drawPerTurn = 0;
+        std::array<uint8_t, 5> reserved{};                  // 对齐 sessionToken
+        std::array<uint64_t, MAX_PLAYER_NUM> sessionToken{};
+        std::array<uint8_t, DECK_CARD_COUNT> deck{};        // 牌堆中牌的下标, 按抽牌顺序
+        std::array<uint8_t, DECK_CARD_COUNT> cardOwner{};   // 同 PlayerTable::cardOwner
+        uint64_t checksum = 0;                              // 之前所有字节的 FNV-1a
+    };
+
+    static_assert(std::is_trivially_copyable_v<MatchSnapshot>);
+    static_assert(std::has_unique_object_representations_v<MatchSnapshot>, "MatchSnapshot 不能有填充字节");
+
+    void seal(MatchSnapshot &snapshot);
+
+    [[nodiscard]] bool isValid(const MatchSnapshot &snapshot);
+
+    [[nodiscard]] std::optional<MatchSnapshot> loadSnapshot(const std::string &path);
+}
+
+#endif //KINGDOMCARD_SNAPSHOT_H
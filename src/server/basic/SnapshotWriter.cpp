@@ -0,0 +1,141 @@
+
+#include "SnapshotWriter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+#include "basic/Metrics.h"
+
+namespace kc {
+    namespace {
+        char const SNAPSHOT_PREFIX[] = "match-";
+        char const SNAPSHOT_SUFFIX[] = ".snap";
+        char const LOCK_FILE[] = ".lock";
+    }
+
+    /// @brief 创建快照目录并启动写线程
+    /// @param directory 快照目录
+    /// @param flush_interval 两次落盘之间的最短间隔, 间隔内的快照合并为一次 fsync
+    SnapshotWriter::SnapshotWriter(std::string directory, std::chrono::milliseconds flush_interval)
+            : directory(std::move(directory)), flushInterval(flush_interval) {
+        std::filesystem::create_directories(this->directory);
+        // 拿不到排他锁说明另一个进程仍在使用该目录, 之后与它一样只持有共享锁
+        lockFd = ::open((this->directory + "/" + LOCK_FILE).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lockFd >= 0) {
+            sharedDirectory = ::flock(lockFd, LOCK_EX | LOCK_NB) != 0;
+            ::flock(lockFd, LOCK_SH);
+        }
+        thread = std::thread(&SnapshotWriter::run, this);
+    }
+
+    /// @brief 写完剩余的快照后退出
+    SnapshotWriter::~SnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isRunning = false;
+        }
+        cv.notify_one();
+        if (thread.joinable())
+            thread.join();
+        if (lockFd >= 0)
+            ::close(lockFd);
+    }
+
+    /// @brief 提交一份快照, 同一对局未落盘的旧快照被覆盖
+    void SnapshotWriter::submit(const MatchSnapshot &snapshot) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pending[snapshot.matchId] = snapshot;
+        }
+        cv.notify_one();
+    }
+
+    /// @brief 对局正常结束, 删除它的快照
+    void SnapshotWriter::discard(uint64_t match_id) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pending[match_id] = std::nullopt;
+        }
+        cv.notify_one();
+    }
+
+    std::string SnapshotWriter::pathOf(uint64_t match_id) const {
+        return directory + "/" + SNAPSHOT_PREFIX + std::to_string(match_id) + SNAPSHOT_SUFFIX;
+    }
+
+    /// @brief 读取目录中所有有效的快照, 无效的文件只记录日志
+    /// @details 启动时目录正被其他进程使用则不读取, 那些是仍在进行的对局
+    std::vector<MatchSnapshot> SnapshotWriter::loadAll() const {
+        std::vector<MatchSnapshot> snapshots;
+        if (sharedDirectory) {
+            spdlog::info("快照目录 {} 正被其他进程使用, 不恢复其中的对局", directory);
+            return snapshots;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind(SNAPSHOT_PREFIX, 0) != 0 || entry.path().extension() != SNAPSHOT_SUFFIX)
+                continue;
+            std::optional<MatchSnapshot> snapshot = loadSnapshot(entry.path().string());
+            if (snapshot.has_value())
+                snapshots.emplace_back(snapshot.value());
+            else
+                spdlog::warn("快照文件 {} 无效, 已忽略", name);
+        }
+        return snapshots;
+    }
+
+    void SnapshotWriter::run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this] { return !isRunning || !pending.empty(); });
+            if (pending.empty())
+                break;
+            std::map<uint64_t, std::optional<MatchSnapshot>> batch;
+            batch.swap(pending);
+            lock.unlock();
+            flush(batch);
+            // 攒一段时间再写下一批, 使 fsync 的次数与回合数无关
+            std::this_thread::sleep_for(flushInterval);
+            lock.lock();
+        }
+    }
+
+    /// @brief 写出一批快照: 先全部 write 到临时文件, 再逐个 fsync 并 rename, 最后 fsync 目录
+    void SnapshotWriter::flush(const std::map<uint64_t, std::optional<MatchSnapshot>> &batch) {
+        std::vector<std::pair<int, uint64_t>> written;
+        for (const auto &[match_id, snapshot] : batch) {
+            std::string path = pathOf(match_id);
+            if (!snapshot.has_value()) {
+                ::unlink(path.c_str());
+                continue;
+            }
+            std::string tmp = path + ".tmp";
+            int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0 || ::write(fd, &snapshot.value(), sizeof(MatchSnapshot)) != sizeof(MatchSnapshot)) {
+                spdlog::error("写入对局 {} 的快照失败: {}", match_id, std::strerror(errno));
+                metrics::increment(metrics::Counter::SNAPSHOT_FAILURES);
+                if (fd >= 0)
+                    ::close(fd);
+                continue;
+            }
+            written.emplace_back(fd, match_id);
+        }
+        for (const auto &[fd, match_id] : written) {
+            std::string path = pathOf(match_id);
+            if (::fsync(fd) != 0 || ::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+                spdlog::error("保存对局 {} 的快照失败: {}", match_id, std::strerror(errno));
+                metrics::increment(metrics::Counter::SNAPSHOT_FAILURES);
+            }
+            ::close(fd);
+        }
+        int dir_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd >= 0) {
+            ::fsync(dir_fd);
+            ::close(dir_fd);
+        }
+    }
+}
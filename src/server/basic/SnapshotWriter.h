@@ -0,0 +1,55 @@
+
+#ifndef KINGDOMCARD_SNAPSHOTWRITER_H
+#define KINGDOMCARD_SNAPSHOTWRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "basic/Snapshot.h"
+
+namespace kc {
+    /// @brief 在后台线程把对局快照写入本地磁盘
+    /// @details 游戏线程只在锁内拷贝一份定长快照; 同一对局尚未落盘的旧快照直接被新的覆盖,
+    ///          写线程每隔 flushInterval 把积攒的快照一起写出, 全部 write 之后再统一 fsync,
+    ///          先写临时文件再 rename, 重启时读到的总是某个完整的回合边界;
+    ///          每个进程对目录中的锁文件持有共享锁, 新进程据此区分上次崩溃遗留的快照与正在排空的旧进程的快照
+    class SnapshotWriter {
+    private:
+        std::string directory;
+        int lockFd = -1;
+        bool sharedDirectory = false;       // 启动时目录正被其他 kc_server 进程使用
+        std::chrono::milliseconds flushInterval;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::map<uint64_t, std::optional<MatchSnapshot>> pending;   // 空值表示删除该对局的快照
+        bool isRunning = true;
+        std::thread thread;
+
+        void run();
+
+        void flush(const std::map<uint64_t, std::optional<MatchSnapshot>> &batch);
+
+    public:
+        explicit SnapshotWriter(std::string directory,
+                                std::chrono::milliseconds flush_interval = std::chrono::milliseconds(50));
+
+        SnapshotWriter(const SnapshotWriter &) = delete;
+
+        ~SnapshotWriter();
+
+        void submit(const MatchSnapshot &snapshot);
+
+        void discard(uint64_t match_id);
+
+        [[nodiscard]] std::string pathOf(uint64_t match_id) const;
+
+        [[nodiscard]] std::vector<MatchSnapshot> loadAll() const;
+    };
+}
+
+#endif //KINGDOMCARD_SNAPSHOTWRITER_H
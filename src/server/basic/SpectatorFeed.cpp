@@ -0,0 +1,48 @@
+
+#include "SpectatorFeed.h"
+
+#include <spdlog/spdlog.h>
+
+namespace kc {
+    /// @brief 连接到 SpectatorHub
+    /// @param context 与 SpectatorHub 相同的 ZeroMQ 上下文
+    /// @param match_id 对局 id
+    SpectatorFeed::SpectatorFeed(zmq::context_t &context, uint64_t match_id)
+            : socket(context, ZMQ_PUB), topic("match-" + std::to_string(match_id) + "/") {
+        socket.set(zmq::sockopt::linger, 0);
+        socket.connect(SPECTATOR_ENDPOINT);
+    }
+
+    /// @brief 是否为可以公开给观众的事件
+    bool SpectatorFeed::isPublic(CommandType type) {
+        switch (type) {
+            case CommandType::GAME_START:
+            case CommandType::GAME_STATUS:
+            case CommandType::NOTICE_CARD:
+            case CommandType::NOTICE_DYING:
+            case CommandType::NOTICE_DEAD:
+            case CommandType::GAME_OVER:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /// @brief 发布一个事件, 非公开的事件直接丢弃; 队列满时丢弃而不阻塞游戏线程
+    void SpectatorFeed::publish(CommandType type, const std::string &msg) {
+        if (!isPublic(type))
+            return;
+        BasicMessage m;
+        m.set_type(type);
+        m.set_message(msg);
+        zmq::message_t payload(m.ByteSizeLong());
+        m.SerializeToArray(payload.data(), static_cast<int>(payload.size()));
+        try {
+            socket.send(zmq::message_t(topic.data(), topic.size()),
+                        zmq::send_flags::sndmore | zmq::send_flags::dontwait);
+            socket.send(payload, zmq::send_flags::dontwait);
+        } catch (zmq::error_t &e) {
+            spdlog::warn("发布观战事件失败: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,31 @@
+
+#ifndef KINGDOMCARD_SPECTATORFEED_H
+#define KINGDOMCARD_SPECTATORFEED_H
+
+#include <string>
+#include <zmq.hpp>
+#include "basic_message.pb.h"
+
+namespace kc {
+    std::string const SPECTATOR_ENDPOINT = "inproc://kc-spectator";    // SpectatorHub 汇集各对局事件的地址
+
+    /// @brief 一局对局的观战事件流
+    /// @details 由 GameController 所在线程独占, 每个公开事件只向 SpectatorHub 非阻塞地发送一次,
+    ///          与观众人数无关; 手牌、身份等隐藏信息所在的消息不会被发布
+    class SpectatorFeed {
+    private:
+        zmq::socket_t socket;
+        std::string topic;                  // "match-<id>/", 观众按前缀订阅某一局
+
+    public:
+        SpectatorFeed(zmq::context_t &context, uint64_t match_id);
+
+        SpectatorFeed(const SpectatorFeed &) = delete;
+
+        [[nodiscard]] static bool isPublic(CommandType type);
+
+        void publish(CommandType type, const std::string &msg);
+    };
+}
+
+#endif //KINGDOMCARD_SPECTATORFEED_H
@@ -0,0 +1,57 @@
+
+#ifndef KINGDOMCARD_SPSCQUEUE_H
+#define KINGDOMCARD_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace kc {
+    /// @brief 单生产者单消费者的无锁环形队列
+    /// @details 两端各自只写自己的下标, 以 release/acquire 交接元素, 元素的所有权随之转移到消费者线程;
+    ///          多个生产者须在外部串行化, 队列满时 push 返回 false 而不阻塞
+    template<typename T, size_t N>
+    class SpscQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue 的容量须为 2 的幂");
+
+    private:
+        std::array<T, N> slots{};
+        alignas(64) std::atomic<size_t> head{0};    // 下一个要读的位置, 只由消费者写
+        alignas(64) std::atomic<size_t> tail{0};    // 下一个要写的位置, 只由生产者写
+
+    public:
+        SpscQueue() = default;
+
+        SpscQueue(const SpscQueue &) = delete;
+
+        /// @brief 生产者放入一个元素
+        /// @return 队列已满时为 false, value 保持不变
+        bool push(T &&value) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N)
+                return false;
+            slots[t & (N - 1)] = std::move(value);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief 消费者取出一个元素, 队列为空时为空值
+        std::optional<T> pop() {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return std::nullopt;
+            std::optional<T> value(std::move(slots[h & (N - 1)]));
+            slots[h & (N - 1)] = T();
+            head.store(h + 1, std::memory_order_release);
+            return value;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+    };
+}
+
+#endif //KINGDOMCARD_SPSCQUEUE_H
@@ -0,0 +1,81 @@
+
+#ifndef KINGDOMCARD_STATICVECTOR_H
+#define KINGDOMCARD_STATICVECTOR_H
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace kc {
+    /// @brief 容量固定的顺序容器, 元素直接存放在对象内部, 不进行堆分配
+    /// @details 用于元素个数有明确上限 (如 MAX_PLAYER_NUM) 的临时列表, 超出容量时抛出 std::length_error
+    template<typename T, size_t N>
+    class StaticVector {
+    private:
+        alignas(T) unsigned char storage[sizeof(T) * N];
+        size_t count = 0;
+
+    public:
+        StaticVector() = default;
+
+        StaticVector(const StaticVector &other) {
+            for (const auto &elem : other)
+                emplace_back(elem);
+        }
+
+        StaticVector(StaticVector &&other) noexcept {
+            for (auto &elem : other)
+                emplace_back(std::move(elem));
+            other.clear();
+        }
+
+        StaticVector &operator=(const StaticVector &) = delete;
+
+        ~StaticVector() { clear(); }
+
+        template<typename... Args>
+        T &emplace_back(Args &&... args) {
+            if (count == N)
+                throw std::length_error("StaticVector 容量不足");
+            T *elem = new(storage + sizeof(T) * count) T(std::forward<Args>(args)...);
+            ++count;
+            return *elem;
+        }
+
+        void push_back(const T &value) { emplace_back(value); }
+
+        void push_back(T &&value) { emplace_back(std::move(value)); }
+
+        void pop_back() { data()[--count].~T(); }
+
+        void clear() {
+            while (count > 0)
+                data()[--count].~T();
+        }
+
+        [[nodiscard]] T *data() { return std::launder(reinterpret_cast<T *>(storage)); }
+
+        [[nodiscard]] const T *data() const { return std::launder(reinterpret_cast<const T *>(storage)); }
+
+        [[nodiscard]] size_t size() const { return count; }
+
+        [[nodiscard]] static constexpr size_t capacity() { return N; }
+
+        [[nodiscard]] bool empty() const { return count == 0; }
+
+        T &operator[](size_t idx) { return data()[idx]; }
+
+        const T &operator[](size_t idx) const { return data()[idx]; }
+
+        T *begin() { return data(); }
+
+        T *end() { return data() + count; }
+
+        const T *begin() const { return data(); }
+
+        const T *end() const { return data() + count; }
+    };
+}
+
+#endif //KINGDOMCARD_STATICVECTOR_H
@@ -0,0 +1,215 @@
+
+#include "TimerWheel.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace kc {
+    TimerWheel::TimerWheel() {
+        slots.fill(NIL);
+        thread = std::thread(&TimerWheel::run, this);
+    }
+
+    /// @brief 停止服务线程, 未到期的定时器不再触发
+    TimerWheel::~TimerWheel() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isRunning = false;
+        }
+        cv.notify_one();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    TimerWheel &TimerWheel::instance() {
+        static TimerWheel wheel;
+        return wheel;
+    }
+
+    /// @brief 登记一个定时器
+    /// @param deadline 到期时间, 已经过去时在下一个刻度触发
+    /// @param callback 到期时在服务线程中调用
+    /// @return 用于取消的 id
+    TimerWheel::TimerId TimerWheel::schedule(std::chrono::steady_clock::time_point deadline, Callback callback) {
+        TimerId id;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            // 空闲时服务线程不推进刻度, 没有定时器时可以直接跳到当前时间
+            if (pending == 0)
+                currentTick = std::max(currentTick, static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - origin).count()));
+            uint32_t index;
+            if (freeNodes.empty()) {
+                index = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+            } else {
+                index = freeNodes.back();
+                freeNodes.pop_back();
+            }
+            Node &node = nodes[index];
+            node.tick = std::max(tickOf(deadline), currentTick + 1);
+            node.callback = std::move(callback);
+            node.active = true;
+            place(index);
+            ++pending;
+            id = static_cast<TimerId>(node.generation) << 32 | index;
+        }
+        cv.notify_one();
+        return id;
+    }
+
+    /// @brief 取消定时器
+    /// @return 定时器已经触发或已被取消时为 false
+    bool TimerWheel::cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto index = static_cast<uint32_t>(id);
+        if (index >= nodes.size() || !nodes[index].active || nodes[index].generation != id >> 32)
+            return false;
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /// @brief 尚未到期的定时器数
+    size_t TimerWheel::size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return pending;
+    }
+
+    /// @brief 时间点对应的刻度, 向上取整, 保证不会提前触发
+    uint64_t TimerWheel::tickOf(std::chrono::steady_clock::time_point time) const {
+        if (time <= origin)
+            return 0;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+        return static_cast<uint64_t>((ns + 999999) / 1000000);
+    }
+
+    /// @brief 放入与当前刻度同属一圈的最低一层
+    /// @details 第 L 层的一格覆盖 64^L 个刻度; 到期刻度与当前刻度在第 L+1 层的同一格内时放在第 L 层,
+    ///          它所在的格子一定在当前位置之后, 这一层转到该格时恰好把它降到更低的层
+    void TimerWheel::place(uint32_t index) {
+        Node &node = nodes[index];
+        size_t level = 0;
+        while (level + 1 < WHEEL_LEVELS
+               && node.tick >> (WHEEL_SLOT_BITS * (level + 1)) != currentTick >> (WHEEL_SLOT_BITS * (level + 1)))
+            ++level;
+        // 超出最高层一圈的定时器先放在最高层, 降层时若仍未到期会再次放置
+        size_t slot = level * WHEEL_SLOTS + ((node.tick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+        node.slot = static_cast<uint16_t>(slot);
+        node.prev = NIL;
+        node.next = slots[slot];
+        if (node.next != NIL)
+            nodes[node.next].prev = index;
+        slots[slot] = index;
+    }
+
+    void TimerWheel::unlink(uint32_t index) {
+        Node &node = nodes[index];
+        if (node.prev != NIL)
+            nodes[node.prev].next = node.next;
+        else
+            slots[node.slot] = node.next;
+        if (node.next != NIL)
+            nodes[node.next].prev = node.prev;
+    }
+
+    void TimerWheel::release(uint32_t index) {
+        Node &node = nodes[index];
+        node.active = false;
+        node.callback = nullptr;
+        ++node.generation;
+        freeNodes.push_back(index);
+        --pending;
+    }
+
+    /// @brief 逐个刻度推进到 target, 到期的回调移入 fired
+    void TimerWheel::advance(uint64_t target, std::vector<Callback> &fired) {
+        while (currentTick < target) {
+            ++currentTick;
+            // 低一层转完一圈时, 把这一层当前格子里的定时器降到更低的层
+            for (size_t level = 1; level < WHEEL_LEVELS; ++level) {
+                if ((currentTick & ((uint64_t(1) << (WHEEL_SLOT_BITS * level)) - 1)) != 0)
+                    break;
+                size_t slot = level * WHEEL_SLOTS + ((currentTick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+                uint32_t index = slots[slot];
+                slots[slot] = NIL;
+                while (index != NIL) {
+                    uint32_t next = nodes[index].next;
+                    place(index);
+                    index = next;
+                }
+            }
+            uint32_t index = slots[currentTick & (WHEEL_SLOTS - 1)];
+            slots[currentTick & (WHEEL_SLOTS - 1)] = NIL;
+            while (index != NIL) {
+                uint32_t next = nodes[index].next;
+                if (nodes[index].tick > currentTick) {
+                    place(index);
+                } else {
+                    fired.emplace_back(std::move(nodes[index].callback));
+                    release(index);
+                }
+                index = next;
+            }
+        }
+    }
+
+    /// @brief 下一个需要处理的刻度: 最低的非空层中当前位置之后的第一个非空格子
+    /// @return 没有定时器时为 UINT64_MAX
+    uint64_t TimerWheel::nextWakeTick() const {
+        if (pending == 0)
+            return UINT64_MAX;
+        for (size_t level = 0; level < WHEEL_LEVELS; ++level) {
+            size_t shift = WHEEL_SLOT_BITS * level;
+            size_t current = (currentTick >> shift) & (WHEEL_SLOTS - 1);
+            for (size_t s = current + 1; s < WHEEL_SLOTS; ++s)
+                if (slots[level * WHEEL_SLOTS + s] != NIL)
+                    return (currentTick >> (shift + WHEEL_SLOT_BITS) << (shift + WHEEL_SLOT_BITS))
+                           | (static_cast<uint64_t>(s) << shift);
+        }
+        size_t top = WHEEL_SLOT_BITS * WHEEL_LEVELS;
+        return ((currentTick >> top) + 1) << top;
+    }
+
+    void TimerWheel::run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        std::vector<Callback> fired;
+        while (isRunning) {
+            advance(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - origin).count()), fired);
+            if (!fired.empty()) {
+                lock.unlock();
+                for (auto &callback : fired)
+                    callback();
+                fired.clear();
+                lock.lock();
+                continue;
+            }
+            uint64_t wake = nextWakeTick();
+            if (wake == UINT64_MAX)
+                cv.wait(lock);
+            else
+                cv.wait_until(lock, origin + std::chrono::milliseconds(wake));
+        }
+    }
+
+    Waker::Waker() : fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+    Waker::~Waker() {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    /// @brief 使 fd 可读, 可在任意线程调用
+    void Waker::notify() {
+        uint64_t one = 1;
+        (void) ::write(fd, &one, sizeof(one));
+    }
+
+    /// @brief 清除可读状态
+    void Waker::drain() {
+        uint64_t count;
+        (void) ::read(fd, &count, sizeof(count));
+    }
+}
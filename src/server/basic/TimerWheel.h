@@ -0,0 +1,116 @@
+
+#ifndef KINGDOMCARD_TIMERWHEEL_H
+#define KINGDOMCARD_TIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kc {
+    size_t const WHEEL_LEVELS = 4;
+    size_t const WHEEL_SLOT_BITS = 6;
+    size_t const WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;    // 每层 64 格, 第 0 层每格 1 ms, 共约 4.6 小时
+
+    /// @brief 所有房间共享的分层时间轮, 精度为 1 ms
+    /// @details 定时器按到期时间落在对应层的格子里, 以下标串成侵入式双向链表, 登记与取消都是 O(1);
+    ///          服务线程只在最近一个非空格子或下一次降层时醒来, 没有定时器时一直休眠.
+    ///          回调在服务线程中执行且不持有锁, 须尽快返回 (如写一次 Waker)
+    class TimerWheel {
+    public:
+        typedef uint64_t TimerId;
+        typedef std::function<void()> Callback;
+
+    private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+
+        struct Node {
+            uint64_t tick = 0;              // 到期的刻度
+            Callback callback;
+            uint32_t prev = NIL;
+            uint32_t next = NIL;
+            uint32_t generation = 0;        // 每次释放后加一, 使旧的 TimerId 失效
+            uint16_t slot = 0;              // 所在格子在 slots 中的下标
+            bool active = false;
+        };
+
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+        uint64_t currentTick = 0;           // 已处理到的刻度
+        std::array<uint32_t, WHEEL_LEVELS * WHEEL_SLOTS> slots{};
+        std::vector<Node> nodes;
+        std::vector<uint32_t> freeNodes;
+        size_t pending = 0;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool isRunning = true;
+        std::thread thread;
+
+        TimerWheel();
+
+        [[nodiscard]] uint64_t tickOf(std::chrono::steady_clock::time_point time) const;
+
+        void place(uint32_t index);
+
+        void unlink(uint32_t index);
+
+        void release(uint32_t index);
+
+        void advance(uint64_t target, std::vector<Callback> &fired);
+
+        [[nodiscard]] uint64_t nextWakeTick() const;
+
+        void run();
+
+    public:
+        TimerWheel(const TimerWheel &) = delete;
+
+        ~TimerWheel();
+
+        static TimerWheel &instance();
+
+        TimerId schedule(std::chrono::steady_clock::time_point deadline, Callback callback);
+
+        bool cancel(TimerId id);
+
+        [[nodiscard]] size_t size();
+    };
+
+    /// @brief 作用域定时器, 析构时取消尚未到期的定时器
+    class ScheduledTimer {
+    private:
+        TimerWheel::TimerId id;
+    public:
+        ScheduledTimer(std::chrono::steady_clock::time_point deadline, TimerWheel::Callback callback)
+                : id(TimerWheel::instance().schedule(deadline, std::move(callback))) {}
+
+        ScheduledTimer(const ScheduledTimer &) = delete;
+
+        ~ScheduledTimer() { TimerWheel::instance().cancel(id); }
+    };
+
+    /// @brief 可以与 ZeroMQ 套接字一起交给 zmq::poll 的唤醒器 (eventfd)
+    /// @details 以 std::shared_ptr 交给定时器回调, 即使等待方已经返回, 迟到的回调也不会写到已关闭的 fd
+    class Waker {
+    private:
+        int fd;
+    public:
+        Waker();
+
+        Waker(const Waker &) = delete;
+
+        ~Waker();
+
+        [[nodiscard]] int getFd() const { return fd; }
+
+        void notify();
+
+        void drain();
+    };
+}
+
+#endif //KINGDOMCARD_TIMERWHEEL_H
@@ -1,33 +1,87 @@
+#include <array>
+#include <cstring>
+#include <thread>
 #include <vector>
 #include <spdlog/spdlog.h>
 #include "Utility.h"
 #include "basic/Player.h"
 #include "basic/GameController.h"
+#include "basic/Metrics.h"
+#include "basic/WireCodec.h"
+#include "basic/FrameCompressor.h"
 
-namespace util {
+namespace kc {
+    /// @brief 将 TurnCardsAvailable 转换为按 CardType 置位的掩码, 供 O(1) 判断
+    uint32_t cardMask(TurnType type) {
+        static auto const masks = [] {
+            std::array<uint32_t, static_cast<size_t>(TurnType::DYING) + 1> m{};
+            for (const auto &[turn, types] : TurnCardsAvailable)
+                for (auto t : types)
+                    m[static_cast<size_t>(turn)] |= 1u << t;
+            return m;
+        }();
+        return masks[static_cast<size_t>(type)];
+    }
+}
 
-    bool sendCommand(kc::Player& player, CommandType commandType, const std::string &message,
-                     std::chrono::milliseconds timeout) {
+namespace {
+    /// @brief 在玩家连接上发出一帧
+    /// @param messages 这一帧包含的消息数
+    bool sendFrame(kc::Player& player, zmq::message_t &frame, size_t messages, std::chrono::milliseconds timeout) {
         try {
-            BasicMessage msg;
-            msg.set_type(commandType);
-            msg.set_player_id(player.id);
-            msg.set_message(message);
-            zmq::message_t connect_msg(msg.ByteSizeLong());
-            msg.SerializeToArray(connect_msg.data(), static_cast<int>(connect_msg.size()));
-            {
-                std::lock_guard<std::mutex> lock(player.mtx);
-                player.socket.set(zmq::sockopt::sndtimeo, static_cast<int>(timeout.count()));
-                player.socket.set(zmq::sockopt::linger, 0);
-                player.socket.send(connect_msg, zmq::send_flags::none);
-            }
+            player.socket.set(zmq::sockopt::sndtimeo, static_cast<int>(timeout.count()));
+            player.socket.set(zmq::sockopt::linger, 0);
+            player.socket.send(frame, zmq::send_flags::none);
         } catch (std::exception &e) {
             spdlog::warn("向玩家{}发送指令失败, 原因是: {}", player.id, e.what());
+            kc::metrics::increment(kc::metrics::Counter::SEND_FAILURES, messages);
             return false;
         }
+        kc::metrics::increment(kc::metrics::Counter::MESSAGES_SENT, messages);
+        kc::metrics::increment(kc::metrics::Counter::FRAMES_SENT);
         return true;
     }
 
+    /// @brief 发出编码好的一条消息, 玩家正在攒消息时只追加到 outbox
+    bool deliver(kc::Player& player, zmq::message_t &frame, std::chrono::milliseconds timeout) {
+        if (!player.isHolding)
+            return sendFrame(player, frame, 1, timeout);
+        auto length = static_cast<uint32_t>(frame.size());
+        player.outbox.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        player.outbox.append(static_cast<const char *>(frame.data()), frame.size());
+        ++player.outboxCount;
+        if (player.outbox.size() >= kc::MAX_BATCH_BYTES || player.outboxCount == UINT16_MAX)
+            return util::flushOutput(player, timeout);
+        return true;
+    }
+}
+
+namespace util {
+
+    /// @brief 发送已经序列化的消息内容
+    /// @details 紧凑编码的连接上只用于没有内容的指令 (CONNECT_ACK、KICK), 带内容的指令须使用 Message 重载
+    bool sendCommand(kc::Player& player, CommandType commandType, const std::string &message,
+                     std::chrono::milliseconds timeout) {
+        // 机器人直接读取游戏状态, 不需要消息
+        if (player.isBot())
+            return true;
+        if (player.wireFormat == wire::PACKED) {
+            if (!message.empty()) {
+                spdlog::error("无法以紧凑编码发送 {}: 消息内容已按 protobuf 序列化", CommandType_Name(commandType));
+                return false;
+            }
+            return sendPacked(player, commandType, "", timeout);
+        }
+        kc::metrics::ScopedTimer timer(kc::metrics::Histogram::SEND_COMMAND);
+        BasicMessage msg;
+        msg.set_type(commandType);
+        msg.set_player_id(player.id);
+        msg.set_message(message);
+        zmq::message_t frame(msg.ByteSizeLong());
+        msg.SerializeToArray(frame.data(), static_cast<int>(frame.size()));
+        return deliver(player, frame, timeout);
+    }
+
     bool sendCommand(const kc::PlayerPtr& player, CommandType commandType, const std::string &message,
                      std::chrono::milliseconds timeout) {
         return sendCommand(*player, commandType, message, timeout);
@@ -38,31 +92,111 @@ namespace util {
         return sendCommand(*player, commandType, message, timeout);
     }
 
+    /// @brief 按玩家协商的编码发送消息
+    bool sendCommand(kc::Player& player, CommandType commandType, const google::protobuf::Message &message,
+                     std::chrono::milliseconds timeout) {
+        if (player.isBot())
+            return true;
+        if (player.wireFormat != wire::PACKED)
+            return sendCommand(player, commandType, message.SerializeAsString(), timeout);
+        std::string body;
+        if (!encodePacked(commandType, message, body)) {
+            spdlog::error("无法以紧凑编码发送 {}", CommandType_Name(commandType));
+            return false;
+        }
+        return sendPacked(player, commandType, body, timeout);
+    }
+
+    /// @brief 在紧凑编码的连接上发送消息, 帧头按玩家填写, body 可在多名玩家之间共用
+    bool sendPacked(kc::Player& player, CommandType commandType, const std::string &body,
+                    std::chrono::milliseconds timeout) {
+        if (player.isBot())
+            return true;
+        kc::metrics::ScopedTimer timer(kc::metrics::Histogram::SEND_COMMAND);
+        zmq::message_t frame(sizeof(wire::Header) + body.size());
+        wire::Header header{wire::VERSION, static_cast<uint8_t>(commandType), player.id};
+        std::memcpy(frame.data(), &header, sizeof(header));
+        std::memcpy(static_cast<char *>(frame.data()) + sizeof(header), body.data(), body.size());
+        return deliver(player, frame, timeout);
+    }
+
+    /// @brief 之后发给玩家的消息先攒下, 由 flushOutput 合为一帧发出; 只对协商了合并帧的玩家生效
+    void holdOutput(kc::Player& player) {
+        player.isHolding = player.batchFrames && !player.isBot();
+    }
+
+    /// @brief 把攒下的消息合为一帧发出, 只有一条时原样发出, 较大的合并帧按协商压缩
+    bool flushOutput(kc::Player& player, std::chrono::milliseconds timeout) {
+        if (player.outboxCount == 0)
+            return true;
+        size_t count = player.outboxCount;
+        zmq::message_t frame;
+        if (count == 1) {
+            frame = zmq::message_t(player.outbox.data() + sizeof(uint32_t), player.outbox.size() - sizeof(uint32_t));
+        } else {
+            thread_local std::string compressed;
+            wire::Batch header{wire::BATCH_MAGIC, 0, static_cast<uint16_t>(count),
+                               static_cast<uint32_t>(player.outbox.size())};
+            const std::string *body = &player.outbox;
+            if (player.zstdFrames && kc::FrameCompressor::instance().compress(player.outbox, compressed)) {
+                header.flags |= wire::BATCH_ZSTD;
+                body = &compressed;
+                kc::metrics::increment(kc::metrics::Counter::FRAMES_COMPRESSED);
+            }
+            frame = zmq::message_t(sizeof(header) + body->size());
+            std::memcpy(frame.data(), &header, sizeof(header));
+            std::memcpy(static_cast<char *>(frame.data()) + sizeof(header), body->data(), body->size());
+        }
+        player.outbox.clear();
+        player.outboxCount = 0;
+        return sendFrame(player, frame, count, timeout);
+    }
+
+    /// @brief 发出攒下的消息, 之后恢复逐条发送
+    bool releaseOutput(kc::Player& player, std::chrono::milliseconds timeout) {
+        bool rtn = flushOutput(player, timeout);
+        player.isHolding = false;
+        return rtn;
+    }
+
     std::optional<CommandType> recvCommand(kc::Player& player, std::string& message,
                                            std::chrono::milliseconds timeout) {
+        kc::metrics::ScopedTimer timer(kc::metrics::Histogram::RECV_COMMAND);
         try {
             zmq::message_t msg;
-            zmq::recv_result_t size;
-            {
-                std::lock_guard<std::mutex> lock(player.mtx);
-                player.socket.set(zmq::sockopt::rcvtimeo, static_cast<int>(timeout.count()));
-                player.socket.set(zmq::sockopt::linger, 0);
-                size = player.socket.recv(msg);
-            }
+            player.socket.set(zmq::sockopt::rcvtimeo, static_cast<int>(timeout.count()));
+            player.socket.set(zmq::sockopt::linger, 0);
+            zmq::recv_result_t size = player.socket.recv(msg);
+            // 客户端可以构造任意内容, 格式错误按返回值处理, 不抛出异常
             if (!size.has_value()) {
-                spdlog::debug("服务器收到了一个空消息");
-                throw std::runtime_error("服务器收到了一个空消息");
+                spdlog::error("从玩家 {} 接受消息失败, 原因是: 服务器收到了一个空消息", player.id);
+                kc::metrics::increment(kc::metrics::Counter::RECV_FAILURES);
+                return std::nullopt;
+            }
+            if (player.wireFormat == wire::PACKED) {
+                const wire::Header *header = wire::header(msg.data(), msg.size());
+                if (header == nullptr) {
+                    spdlog::error("从玩家 {} 接受消息失败, 原因是: 帧头长度或版本错误", player.id);
+                    kc::metrics::increment(kc::metrics::Counter::RECV_FAILURES);
+                    return std::nullopt;
+                }
+                message.assign(static_cast<const char *>(msg.data()) + sizeof(wire::Header),
+                               msg.size() - sizeof(wire::Header));
+                kc::metrics::increment(kc::metrics::Counter::MESSAGES_RECEIVED);
+                return static_cast<CommandType>(header->type);
             }
             BasicMessage parsedMessage;
-            bool result = parsedMessage.ParseFromString(msg.to_string());
-            if (!result) {
-                spdlog::debug("无法解析消息内容, 消息文本为: {}", msg.to_string());
-                throw std::runtime_error("无法解析消息内容");
+            if (!parsedMessage.ParseFromArray(msg.data(), static_cast<int>(msg.size()))) {
+                spdlog::error("从玩家 {} 接受消息失败, 原因是: 无法解析消息内容", player.id);
+                kc::metrics::increment(kc::metrics::Counter::RECV_FAILURES);
+                return std::nullopt;
             }
             message = parsedMessage.message();
+            kc::metrics::increment(kc::metrics::Counter::MESSAGES_RECEIVED);
             return parsedMessage.type();
         } catch (std::exception &e) {
             spdlog::error("从玩家 {} 接受消息失败, 原因是: {}", player.id, e.what());
+            kc::metrics::increment(kc::metrics::Counter::RECV_FAILURES);
             return std::nullopt;
         }
     }
@@ -77,6 +211,90 @@ namespace util {
         return recvCommand(player, message);
     }
 
+    /// @brief 按玩家协商的编码解析 recvCommand 收到的消息内容
+    bool parsePayload(const kc::Player& player, CommandType commandType, const std::string &payload,
+                      google::protobuf::Message &message) {
+        if (player.wireFormat == wire::PACKED)
+            return decodePacked(commandType, payload.data(), payload.size(), message);
+        return message.ParseFromString(payload);
+    }
+
+    /// @brief 与客户端交换时间戳, 估计客户端单调时钟相对服务器的偏移, 结果写入 player.clockOffset
+    /// @details 服务器发出带发送时刻的 CLOCK_SYNC, 客户端填入收到时自己的时刻后原样带回;
+    ///          取往返最短的一轮, 假定去程与回程各占一半
+    /// @param rounds 交换的轮数
+    /// @param timeout 每轮等待回复的时间
+    /// @param deadline 到达后不再开始新的一轮, 进行中的一轮也只等到此时
+    /// @return 至少完成了一轮
+    bool syncClock(kc::Player& player, size_t rounds, std::chrono::milliseconds timeout,
+                   std::chrono::steady_clock::time_point deadline) {
+        using namespace std::chrono;
+        std::optional<steady_clock::duration> best_rtt;
+        for (size_t r = 0; r < rounds; ++r) {
+            auto sent = steady_clock::now();
+            if (sent >= deadline)
+                break;
+            if (deadline - sent < timeout)
+                timeout = duration_cast<milliseconds>(deadline - sent);
+            ClockSync probe;
+            probe.set_server_time(duration_cast<microseconds>(sent.time_since_epoch()).count());
+            probe.set_remaining_rounds(static_cast<uint32_t>(rounds - r - 1));
+            if (!sendCommand(player, CommandType::CLOCK_SYNC, probe, timeout))
+                break;
+            // 握手前后残留的 CONNECT_ACK 等消息直接跳过
+            ClockSync reply;
+            bool answered = false;
+            while (!answered && steady_clock::now() - sent < timeout) {
+                std::string msg;
+                RecvResult rslt = recvCommand(player, msg, timeout);
+                if (!rslt.has_value())
+                    break;
+                answered = rslt.value() == CommandType::CLOCK_SYNC
+                           && parsePayload(player, CommandType::CLOCK_SYNC, msg, reply)
+                           && reply.server_time() == probe.server_time();
+            }
+            if (!answered)
+                break;
+            auto rtt = steady_clock::now() - sent;
+            if (!best_rtt.has_value() || rtt < best_rtt.value()) {
+                best_rtt = rtt;
+                player.clockOffset = microseconds(reply.client_time())
+                                     - duration_cast<microseconds>(sent.time_since_epoch() + rtt / 2);
+            }
+        }
+        if (!best_rtt.has_value()) {
+            spdlog::warn("玩家 {} 时钟同步失败, 截止时刻只以剩余时间下发", player.id);
+            return false;
+        }
+        spdlog::debug("玩家 {} 时钟偏移 {}us, 往返 {}us", player.id, player.clockOffset->count(),
+                      duration_cast<microseconds>(best_rtt.value()).count());
+        return true;
+    }
+
+    /// @brief 同时与一桌的真人玩家同步时钟, 所有玩家共用一个截止时刻
+    /// @details 每名玩家在各自的线程中探测, 只使用自己的套接字; 无论有几名玩家不应答, 本桌最多等待 budget
+    /// @param budget 本桌同步时钟的总时间
+    void syncClocks(const std::vector<kc::PlayerPtr>& players, std::chrono::milliseconds budget) {
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        std::vector<std::thread> probes;
+        for (const auto &player : players)
+            if (!player->isBot())
+                probes.emplace_back([&player, deadline]() {
+                    syncClock(*player, kc::CLOCK_SYNC_ROUNDS, kc::CLOCK_SYNC_TIMEOUT, deadline);
+                });
+        for (auto &probe : probes)
+            probe.join();
+    }
+
+    /// @brief 把服务器的时刻换算到客户端的单调时钟上
+    /// @return 客户端时钟上的毫秒数, 未完成时钟同步时为 0
+    int64_t toClientTime(const kc::Player& player, std::chrono::steady_clock::time_point time) {
+        using namespace std::chrono;
+        if (!player.clockOffset.has_value())
+            return 0;
+        return duration_cast<milliseconds>(time.time_since_epoch() + player.clockOffset.value()).count();
+    }
+
     PlayerIdentity_pb to_pb(kc::PlayerIdentity identity) {
         return static_cast<PlayerIdentity_pb>(identity - 1);
     }
@@ -89,6 +307,10 @@ namespace util {
         return static_cast<TurnType_pb>(type);
     }
 
+    RejectReason_pb to_pb(kc::PlayError error) {
+        return static_cast<RejectReason_pb>(error);
+    }
+
     kc::PlayerIdentity to_kc(PlayerIdentity_pb identity) {
         return static_cast<kc::PlayerIdentity>(identity + 1);
     }
@@ -101,12 +323,13 @@ namespace util {
         return static_cast<kc::TurnType>(type);
     }
 
-    Player_pb to_pb(const kc::Player& player) {
+    Player_pb to_pb(const kc::PlayerTable& table, size_t seat) {
         Player_pb pb;
-        pb.set_id(player.id);
-        pb.set_hp(player.getHealth());
-        pb.set_maxhp(player.getMaxHealth());
-        pb.set_cardcnt(player.getCardCount());
+        pb.set_id(table.id[seat]);
+        pb.set_hp(table.hp[seat]);
+        pb.set_maxhp(table.maxHp[seat]);
+        pb.set_cardcnt(table.cardCount[seat]);
+        pb.set_isalive(table.alive[seat]);
         return pb;
     }
 
@@ -3,7 +3,9 @@
 #define KINGDOMCARD_UTILITY_H
 
 #include <optional>
+#include <vector>
 #include "basic/Player.h"
+#include "basic/PlayerTable.h"
 #include "basic/Card.h"
 #include "basic_message.pb.h"
 #include "basic_object.pb.h"
@@ -31,6 +33,40 @@ namespace kc {
             {TurnType::DODGE_WAIT, {CardType::DODGE}},
             {TurnType::DYING, {CardType::PEACH, CardType::PEACH_GARDEN_OATH}}
     };
+
+    [[nodiscard]] uint32_t cardMask(TurnType type);
+
+    size_t const CLOCK_SYNC_ROUNDS = 4;     // 开局时交换时间戳的轮数, 取往返最短的一轮
+    std::chrono::milliseconds const CLOCK_SYNC_TIMEOUT(200);   // 每轮等待回复的时间
+    std::chrono::milliseconds const CLOCK_SYNC_BUDGET(500);    // 一桌开局前同步时钟的总时间, 不应答的客户端最多拖慢本桌这么久
+    size_t const MAX_BATCH_BYTES = 16 * 1024;   // 攒下的消息达到此长度时不再等待, 立即合为一帧发出
+
+    /// @brief 出牌校验的结果, 非法出牌以返回值报告而不抛出异常
+    enum class PlayError {
+        NONE,               // 合法
+        NOT_IN_HAND,        // 手牌中没有这张牌
+        WRONG_TYPE,         // 牌的类型与声明不符
+        NOT_PLAYABLE,       // 当前阶段不能打出这种牌
+        NO_SUCH_PLAYER,     // 目标玩家不存在
+        SELF_TARGET,        // 不能以自己为目标
+        TARGET_DEAD,        // 目标已经死亡
+        FULL_HEALTH,        // 满血不能使用桃
+        DUPLICATE_CARD,     // 弃牌列表中有重复的牌
+        TOO_FEW_DISCARDS    // 弃牌后手牌仍多于体力
+    };
+
+    std::string const PlayErrorName[] = {
+            "合法",
+            "手牌中没有这张牌",
+            "牌的类型不匹配",
+            "当前不能打出这种牌",
+            "目标玩家不存在",
+            "不能以自己为目标",
+            "目标已经死亡",
+            "满血不能使用桃",
+            "弃牌重复",
+            "弃牌数量过少"
+    };
 }
 
 namespace util {
@@ -40,18 +76,34 @@ namespace util {
                      std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
     bool sendCommand(kc::Player *player, CommandType commandType, const std::string &message,
                      std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool sendCommand(kc::Player& player, CommandType commandType, const google::protobuf::Message &message,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool sendPacked(kc::Player& player, CommandType commandType, const std::string &body,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    void holdOutput(kc::Player& player);
+    bool flushOutput(kc::Player& player, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool releaseOutput(kc::Player& player, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
     typedef std::optional<CommandType> RecvResult;
     RecvResult recvCommand(const kc::PlayerPtr& player);
     RecvResult recvCommand(const kc::PlayerPtr& player, std::string& message,
                            std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
     RecvResult recvCommand(kc::Player& player, std::string& message,
                            std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool parsePayload(const kc::Player& player, CommandType commandType, const std::string &payload,
+                      google::protobuf::Message &message);
+    bool syncClock(kc::Player& player, size_t rounds = kc::CLOCK_SYNC_ROUNDS,
+                   std::chrono::milliseconds timeout = kc::CLOCK_SYNC_TIMEOUT,
+                   std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+    void syncClocks(const std::vector<kc::PlayerPtr>& players,
+                    std::chrono::milliseconds budget = kc::CLOCK_SYNC_BUDGET);
+    int64_t toClientTime(const kc::Player& player, std::chrono::steady_clock::time_point time);
 
     PlayerIdentity_pb to_pb(kc::PlayerIdentity identity);
     CardType_pb to_pb(kc::CardType type);
-    Player_pb to_pb(const kc::Player& player);
+    Player_pb to_pb(const kc::PlayerTable& table, size_t seat);
     Card_pb to_pb(const kc::Card& card);
     TurnType_pb to_pb(kc::TurnType type);
+    RejectReason_pb to_pb(kc::PlayError error);
     kc::PlayerIdentity to_kc(PlayerIdentity_pb identity);
     kc::CardType to_kc(CardType_pb type);
     kc::TurnType to_kc(TurnType_pb type);
@@ -0,0 +1,273 @@
+#include "WireCodec.h"
+#include "basic_object.pb.h"
+#include "command.pb.h"
+
+namespace {
+    wire::Card toWire(const Card_pb &card) {
+        return wire::Card{static_cast<uint16_t>(card.id()), static_cast<uint8_t>(card.type())};
+    }
+
+    void fromWire(const wire::Card &card, Card_pb *pb) {
+        pb->set_id(card.id);
+        pb->set_type(static_cast<CardType_pb>(card.type));
+    }
+
+    template<typename Cards>
+    void appendCards(std::string &out, const Cards &cards) {
+        wire::append(out, wire::CardList{static_cast<uint8_t>(cards.size())});
+        for (const auto &card : cards)
+            wire::append(out, toWire(card));
+    }
+
+    /// @brief 定长的消息体, 长度须恰好为 sizeof(T)
+    template<typename T>
+    const T *exact(const char *body, size_t size) {
+        return size == sizeof(T) ? wire::view<T>(body, size) : nullptr;
+    }
+
+    /// @brief 读取 CardList 及其后的牌, 长度须恰好容纳 count 张
+    template<typename Cards>
+    bool readCards(const char *body, size_t size, Cards *cards) {
+        const auto *list = wire::view<wire::CardList>(body, size);
+        if (list == nullptr || size != sizeof(wire::CardList) + list->count * sizeof(wire::Card))
+            return false;
+        const auto *items = wire::viewArray<wire::Card>(body, size, sizeof(wire::CardList), list->count);
+        cards->Reserve(list->count);
+        for (size_t i = 0; i < list->count; ++i)
+            fromWire(items[i], cards->Add());
+        return true;
+    }
+}
+
+namespace util {
+    bool encodePacked(CommandType commandType, const google::protobuf::Message &message, std::string &out) {
+        switch (commandType) {
+            case CommandType::GAME_START: {
+                const auto *pb = dynamic_cast<const GameStart *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::GameStart{static_cast<uint8_t>(pb->playeridentity()),
+                                                  pb->lordid()});
+                return true;
+            }
+            case CommandType::GAME_STATUS: {
+                const auto *pb = dynamic_cast<const GameStatus *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::GameStatus{static_cast<uint8_t>(pb->players_size()),
+                                                   pb->currentturnplayerid()});
+                for (const auto &player : pb->players())
+                    wire::append(out, wire::PlayerState{player.id(),
+                                                        static_cast<uint8_t>(player.hp()),
+                                                        static_cast<uint8_t>(player.maxhp()),
+                                                        static_cast<uint8_t>(player.cardcnt()),
+                                                        static_cast<uint8_t>(player.isalive())});
+                return true;
+            }
+            case CommandType::NOTICE_CARD: {
+                const auto *pb = dynamic_cast<const NoticeCard *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::NoticeCard{pb->playerid(), toWire(pb->card()),
+                                                   pb->targetplayerid()});
+                return true;
+            }
+            case CommandType::NOTICE_DYING: {
+                const auto *pb = dynamic_cast<const NoticeDying *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::NoticePlayer{pb->playerid()});
+                return true;
+            }
+            case CommandType::NOTICE_DEAD: {
+                const auto *pb = dynamic_cast<const NoticeDead *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::NoticePlayer{pb->playerid()});
+                return true;
+            }
+            case CommandType::GAME_OVER: {
+                const auto *pb = dynamic_cast<const GameOver *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::GameOver{static_cast<uint8_t>(pb->victorycamp())});
+                return true;
+            }
+            case CommandType::YOUR_TURN: {
+                const auto *pb = dynamic_cast<const YourTurn *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::YourTurn{pb->deadline(), pb->remainingtime(),
+                                                 static_cast<uint8_t>(pb->turntype())});
+                return true;
+            }
+            case CommandType::NEW_CARD: {
+                const auto *pb = dynamic_cast<const NewCard *>(&message);
+                if (pb == nullptr)
+                    return false;
+                appendCards(out, pb->newcards());
+                return true;
+            }
+            case CommandType::DISCARD_CARD: {
+                const auto *pb = dynamic_cast<const DiscardCard *>(&message);
+                if (pb == nullptr)
+                    return false;
+                appendCards(out, pb->discardedcards());
+                return true;
+            }
+            case CommandType::ACTION_PLAY: {
+                const auto *pb = dynamic_cast<const ActionPlay *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::ActionPlay{toWire(pb->card()), pb->targetplayerid()});
+                return true;
+            }
+            case CommandType::ACTION_PASS: {
+                const auto *pb = dynamic_cast<const ActionPass *>(&message);
+                if (pb == nullptr)
+                    return false;
+                appendCards(out, pb->discardedcards());
+                return true;
+            }
+            case CommandType::ACTION_REJECT: {
+                const auto *pb = dynamic_cast<const ActionReject *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::ActionReject{toWire(pb->card()), static_cast<uint8_t>(pb->reason())});
+                return true;
+            }
+            case CommandType::CLOCK_SYNC: {
+                const auto *pb = dynamic_cast<const ClockSync *>(&message);
+                if (pb == nullptr)
+                    return false;
+                wire::append(out, wire::ClockSync{pb->server_time(), pb->client_time(), pb->remaining_rounds()});
+                return true;
+            }
+            default:
+                // CONNECT_ACK 与 KICK 没有消息体, 登入端口上的消息不走紧凑编码
+                return false;
+        }
+    }
+
+    bool decodePacked(CommandType commandType, const char *body, size_t size, google::protobuf::Message &message) {
+        message.Clear();
+        switch (commandType) {
+            case CommandType::GAME_START: {
+                auto *pb = dynamic_cast<GameStart *>(&message);
+                const auto *w = exact<wire::GameStart>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_playeridentity(static_cast<PlayerIdentity_pb>(w->identity));
+                pb->set_lordid(w->lordId);
+                return true;
+            }
+            case CommandType::GAME_STATUS: {
+                auto *pb = dynamic_cast<GameStatus *>(&message);
+                const auto *w = wire::view<wire::GameStatus>(body, size);
+                if (pb == nullptr || w == nullptr
+                    || size != sizeof(wire::GameStatus) + w->totalPlayers * sizeof(wire::PlayerState))
+                    return false;
+                const auto *players = wire::viewArray<wire::PlayerState>(body, size, sizeof(wire::GameStatus),
+                                                                         w->totalPlayers);
+                pb->set_totalplayers(w->totalPlayers);
+                pb->set_currentturnplayerid(w->currentTurnPlayerId);
+                pb->mutable_players()->Reserve(w->totalPlayers);
+                for (size_t i = 0; i < w->totalPlayers; ++i) {
+                    Player_pb *player = pb->add_players();
+                    player->set_id(players[i].id);
+                    player->set_hp(players[i].hp);
+                    player->set_maxhp(players[i].maxHp);
+                    player->set_cardcnt(players[i].cardCount);
+                    player->set_isalive(players[i].alive != 0);
+                }
+                return true;
+            }
+            case CommandType::NOTICE_CARD: {
+                auto *pb = dynamic_cast<NoticeCard *>(&message);
+                const auto *w = exact<wire::NoticeCard>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_playerid(w->playerId);
+                fromWire(w->card, pb->mutable_card());
+                pb->set_targetplayerid(w->targetPlayerId);
+                return true;
+            }
+            case CommandType::NOTICE_DYING: {
+                auto *pb = dynamic_cast<NoticeDying *>(&message);
+                const auto *w = exact<wire::NoticePlayer>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_playerid(w->playerId);
+                return true;
+            }
+            case CommandType::NOTICE_DEAD: {
+                auto *pb = dynamic_cast<NoticeDead *>(&message);
+                const auto *w = exact<wire::NoticePlayer>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_playerid(w->playerId);
+                return true;
+            }
+            case CommandType::GAME_OVER: {
+                auto *pb = dynamic_cast<GameOver *>(&message);
+                const auto *w = exact<wire::GameOver>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_victorycamp(static_cast<PlayerIdentity_pb>(w->victoryCamp));
+                return true;
+            }
+            case CommandType::YOUR_TURN: {
+                auto *pb = dynamic_cast<YourTurn *>(&message);
+                const auto *w = exact<wire::YourTurn>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_deadline(w->deadline);
+                pb->set_remainingtime(w->remainingTime);
+                pb->set_turntype(static_cast<TurnType_pb>(w->turnType));
+                return true;
+            }
+            case CommandType::NEW_CARD: {
+                auto *pb = dynamic_cast<NewCard *>(&message);
+                return pb != nullptr && readCards(body, size, pb->mutable_newcards());
+            }
+            case CommandType::DISCARD_CARD: {
+                auto *pb = dynamic_cast<DiscardCard *>(&message);
+                return pb != nullptr && readCards(body, size, pb->mutable_discardedcards());
+            }
+            case CommandType::ACTION_PLAY: {
+                auto *pb = dynamic_cast<ActionPlay *>(&message);
+                const auto *w = exact<wire::ActionPlay>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                fromWire(w->card, pb->mutable_card());
+                pb->set_targetplayerid(w->targetPlayerId);
+                return true;
+            }
+            case CommandType::ACTION_PASS: {
+                auto *pb = dynamic_cast<ActionPass *>(&message);
+                return pb != nullptr && readCards(body, size, pb->mutable_discardedcards());
+            }
+            case CommandType::ACTION_REJECT: {
+                auto *pb = dynamic_cast<ActionReject *>(&message);
+                const auto *w = exact<wire::ActionReject>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                fromWire(w->card, pb->mutable_card());
+                pb->set_reason(static_cast<RejectReason_pb>(w->reason));
+                return true;
+            }
+            case CommandType::CLOCK_SYNC: {
+                auto *pb = dynamic_cast<ClockSync *>(&message);
+                const auto *w = exact<wire::ClockSync>(body, size);
+                if (pb == nullptr || w == nullptr)
+                    return false;
+                pb->set_server_time(w->serverTime);
+                pb->set_client_time(w->clientTime);
+                pb->set_remaining_rounds(w->remainingRounds);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+
+#ifndef KINGDOMCARD_WIRECODEC_H
+#define KINGDOMCARD_WIRECODEC_H
+
+#include <string>
+#include <google/protobuf/message.h>
+#include "basic_message.pb.h"
+#include "packed_wire.h"
+
+namespace util {
+    /// @brief 把玩家连接上的 protobuf 消息写成紧凑编码的消息体, 追加到 out 之后 (不含帧头)
+    /// @param commandType 决定 message 的具体类型, 与之不符时返回 false
+    bool encodePacked(CommandType commandType, const google::protobuf::Message &message, std::string &out);
+
+    /// @brief 把紧凑编码的消息体还原为 commandType 对应的 protobuf 消息
+    /// @return 长度与类型都符合时为 true
+    bool decodePacked(CommandType commandType, const char *body, size_t size, google::protobuf::Message &message);
+}
+
+#endif //KINGDOMCARD_WIRECODEC_H
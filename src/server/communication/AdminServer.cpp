@@ -0,0 +1,250 @@
+#include <spdlog/spdlog.h>
+
+#include <sstream>
+#include <unistd.h>
+#include "AdminServer.h"
+#include "Listener.h"
+#include "basic/Metrics.h"
+
+namespace kc {
+    namespace {
+        std::string const HELP =
+                "OK\n"
+                "stats: 大厅, 匹配队列与对局数, 主要计数器以及各分片的对局数\n"
+                "rooms: 列出进行中的对局\n"
+                "room <match_id>: 对局详情\n"
+                "start: 用大厅中的玩家立即开一桌\n"
+                "destroy <match_id>: 在下一个回合边界解散对局\n"
+                "players: 列出大厅中的玩家\n"
+                "kick <player_id>: 踢出大厅或匹配队列中的玩家\n"
+                "check: 检查大厅中的玩家是否在线\n"
+                "max <start_num>: 最大等待人数\n"
+                "bots <num>: 添加 num 个机器人\n"
+                "mcts <budget_ms> <threads>: 之后添加的机器人使用 ISMCTS, budget_ms 为 0 时关闭\n"
+                "match: 开启匹配, 之后连接的玩家按分数自动组桌\n"
+                "drain: 关闭登入端口, 踢出等待中的玩家, 进行中的对局照常结束\n"
+                "config: 当前的房间规则\n"
+                "reload: 重新加载配置文件, 之后开始的对局生效\n"
+                "shutdown: 排空后等待进行中的对局结束, 随即退出服务器\n";
+
+        long long toMs(std::chrono::steady_clock::duration d) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+        }
+
+        /// @brief 一行对局概况
+        void describe(std::ostringstream &out, const Room &room) {
+            const MatchStatus &status = room.getStatus();
+            out << room.getId() << " rules=" << room.getRules().name
+                << " players=" << room.playerCount()
+                << " alive=" << +status.aliveCount.load(std::memory_order_relaxed)
+                << " turn=" << status.turn.load(std::memory_order_relaxed)
+                << " current=" << status.currentPlayer.load(std::memory_order_relaxed)
+                << " elapsed_ms=" << toMs(room.elapsed())
+                << (room.isFinished() ? " finished" : "") << '\n';
+        }
+    }
+
+    /// @brief 管理服务构造函数
+    /// @param context ZeroMQ 上下文
+    /// @param server 被管理的游戏服务器, 须比管理服务后析构
+    /// @param port 管理端口号
+    AdminServer::AdminServer(zmq::context_t &context, GameServer &server, const uint16_t port) : server(server) {
+        repSocket = zmq::socket_t(context, ZMQ_REP);
+        repSocket.set(zmq::sockopt::rcvtimeo, 500);
+        repSocket.set(zmq::sockopt::linger, 0);
+        std::string ipc = "ipc://" + ADMIN_IPC_DIRECTORY + "/kc-admin-" + std::to_string(::getpid()) + ".ipc";
+        repSocket.bind(ipc);
+        spdlog::info("管理服务已开放端点: {}", ipc);
+        tcpEndpoint = "tcp://127.0.0.1:" + std::to_string(port);
+        takeOverPort();
+        if (!isTcpBound)
+            spdlog::warn("管理端口 {} 被占用, 可能属于正在交接的旧进程, 之后重试", port);
+    }
+
+    /// @brief 尝试绑定管理端口, 已绑定时不做任何事
+    void AdminServer::takeOverPort() {
+        if (isTcpBound || !bindIfFree(repSocket, tcpEndpoint))
+            return;
+        isTcpBound = true;
+        spdlog::info("管理服务已开放端点: {}", tcpEndpoint);
+    }
+
+    /// @brief 管理服务析构函数
+    AdminServer::~AdminServer() {
+        stop();
+    }
+
+    /// @brief 开始应答管理命令
+    void AdminServer::start() {
+        if (isServing)
+            return;
+        isServing = true;
+        serveThread = std::thread(&AdminServer::serve, this);
+    }
+
+    /// @brief 停止应答管理命令并释放端口, 之后不能再次开始
+    void AdminServer::stop() {
+        isServing = false;
+        if (serveThread.joinable())
+            serveThread.join();
+        repSocket.close();
+    }
+
+    /// @brief 使 waitForShutdown 返回, 可在任意线程调用
+    void AdminServer::requestShutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            shutdownRequested = true;
+        }
+        shutdownCv.notify_all();
+    }
+
+    /// @brief 阻塞直到收到 shutdown 命令或调用 requestShutdown
+    void AdminServer::waitForShutdown() {
+        std::unique_lock<std::mutex> lock(mtx);
+        shutdownCv.wait(lock, [this]() { return shutdownRequested; });
+    }
+
+    /// @brief 应答循环, 一次处理一条命令
+    void AdminServer::serve() {
+        while (isServing) {
+            try {
+                takeOverPort();
+                zmq::message_t request;
+                if (!repSocket.recv(request).has_value())
+                    continue;
+                std::string reply;
+                try {
+                    reply = handle(request.to_string());
+                } catch (std::exception &e) {
+                    reply = std::string("ERR ") + e.what() + "\n";
+                }
+                repSocket.send(zmq::message_t(reply.data(), reply.size()), zmq::send_flags::none);
+            } catch (std::exception &e) {
+                spdlog::error("管理服务响应失败: {}", e.what());
+            }
+        }
+    }
+
+    /// @brief 执行一条管理命令
+    /// @param request "命令 参数..."
+    /// @return 应答文本, 首行为 OK 或 ERR 加原因
+    std::string AdminServer::handle(const std::string &request) {
+        std::istringstream in(request);
+        std::ostringstream out;
+        std::string command;
+        in >> command;
+        spdlog::debug("管理命令: {}", request);
+        if (command.empty() || command == "help")
+            return HELP;
+        if (command == "stats") {
+            auto &registry = metrics::Registry::instance();
+            out << "OK\n"
+                << "lobby " << server.lobbyPlayers().size() << '\n'
+                << "queue " << server.queueSize() << '\n'
+                << "rooms " << server.activeRooms() << '\n'
+                << "matchmaking " << server.isMatchmaking() << '\n'
+                << "draining " << server.isDrainMode() << '\n'
+                << "matches_formed " << registry.value(metrics::Counter::MATCHES_FORMED) << '\n'
+                << "messages_sent " << registry.value(metrics::Counter::MESSAGES_SENT) << '\n'
+                << "send_failures " << registry.value(metrics::Counter::SEND_FAILURES) << '\n'
+                << "messages_received " << registry.value(metrics::Counter::MESSAGES_RECEIVED) << '\n'
+                << "recv_failures " << registry.value(metrics::Counter::RECV_FAILURES) << '\n'
+                << "turn_timeouts " << registry.value(metrics::Counter::TURN_TIMEOUTS) << '\n';
+            for (const auto &shard : server.getShards())
+                out << "shard " << shard->getIndex() << " cpu=" << shard->getCpu()
+                    << " rooms=" << shard->getLoad() << '\n';
+        } else if (command == "rooms") {
+            out << "OK\n";
+            for (const auto &room : *server.roomSnapshot())
+                if (!room->isFinished())
+                    describe(out, *room);
+        } else if (command == "room") {
+            uint64_t match_id;
+            if (!(in >> match_id))
+                return "ERR 用法: room <match_id>\n";
+            for (const auto &room : *server.roomSnapshot()) {
+                if (room->getId() != match_id)
+                    continue;
+                const RoomRules &rules = room->getRules();
+                out << "OK\n";
+                describe(out, *room);
+                out << "player_ids";
+                for (uint32_t id : room->playerIds())
+                    out << ' ' << id;
+                out << "\nturn_time_limit_ms " << toMs(rules.turnTimeLimit)
+                    << "\nreact_time_limit_ms " << toMs(rules.reactTimeLimit)
+                    << "\ndeck_size " << rules.deckSize() << '\n';
+                return out.str();
+            }
+            return "ERR 对局不存在\n";
+        } else if (command == "start") {
+            server.start();
+            out << "OK\n";
+        } else if (command == "destroy") {
+            uint64_t match_id;
+            if (!(in >> match_id))
+                return "ERR 用法: destroy <match_id>\n";
+            if (!server.destroyRoom(match_id))
+                return "ERR 对局不存在\n";
+            out << "OK\n";
+        } else if (command == "players") {
+            out << "OK\n";
+            for (const auto &player : server.lobbyPlayers())
+                out << player->id << (player->isBot() ? " bot" : "") << '\n';
+        } else if (command == "kick") {
+            unsigned player_id;
+            if (!(in >> player_id))
+                return "ERR 用法: kick <player_id>\n";
+            if (!server.kickPlayer(player_id))
+                return "ERR 玩家不在大厅或匹配队列中\n";
+            out << "OK\n";
+        } else if (command == "check") {
+            server.checkAndKick();
+            out << "OK\nlobby " << server.lobbyPlayers().size() << '\n';
+        } else if (command == "max") {
+            unsigned start_num;
+            if (!(in >> start_num))
+                return "ERR 用法: max <start_num>\n";
+            server.setWaitingPlayerNum(start_num);
+            out << "OK\n";
+        } else if (command == "bots") {
+            unsigned num;
+            if (!(in >> num))
+                return "ERR 用法: bots <num>\n";
+            server.addBots(num);
+            out << "OK\n";
+        } else if (command == "mcts") {
+            unsigned budget, threads;
+            if (!(in >> budget >> threads))
+                return "ERR 用法: mcts <budget_ms> <threads>\n";
+            server.setMctsBots(budget > 0, std::chrono::milliseconds(budget), threads);
+            out << "OK\n";
+        } else if (command == "match") {
+            server.enableMatchmaking();
+            out << "OK\n";
+        } else if (command == "drain") {
+            server.drain();
+            out << "OK\n";
+        } else if (command == "config") {
+            auto config = server.currentConfig();
+            out << "OK\nport " << config->port << '\n';
+            for (const auto &rules : config->rooms)
+                out << rules.name << " players=" << rules.minPlayers << '-' << rules.maxPlayers
+                    << " turn_ms=" << toMs(rules.turnTimeLimit)
+                    << " react_ms=" << toMs(rules.reactTimeLimit)
+                    << " deck=" << rules.deckSize()
+                    << " hand=" << rules.initialHand << " draw=" << rules.drawPerTurn << '\n';
+        } else if (command == "reload") {
+            if (!server.reloadConfig())
+                return "ERR 重新加载失败, 保留原来的配置\n";
+            out << "OK\n";
+        } else if (command == "shutdown") {
+            requestShutdown();
+            out << "OK\n";
+        } else {
+            return "ERR 未知命令: " + command + "\n";
+        }
+        return out.str();
+    }
+}
@@ -0,0 +1,58 @@
+
+#ifndef KINGDOMCARD_ADMINSERVER_H
+#define KINGDOMCARD_ADMINSERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+#include "communication/GameServer.h"
+
+namespace kc {
+    uint16_t const ADMIN_PORT = 13361;
+    std::string const ADMIN_IPC_DIRECTORY = "/tmp";    // 每个进程另有 ipc://ADMIN_IPC_DIRECTORY/kc-admin-<pid>.ipc
+
+    /// @brief 管理端口, 只监听本地回环地址, 取代从标准输入读取命令
+    /// @details REP 套接字在独立线程中应答一行文本命令, 应答以 "OK" 或 "ERR" 开头;
+    ///          TCP 端口同一时刻只属于一个进程, 交接时新进程等旧进程释放后再接管, 两个进程都可以经各自的 ipc 端点访问;
+    ///          对局列表与进度读取 GameServer 的房间快照与各房间的 MatchStatus, 不与游戏线程争用锁
+    class AdminServer {
+    private:
+        GameServer &server;
+        zmq::socket_t repSocket;
+        std::string tcpEndpoint;
+        bool isTcpBound = false;
+        std::thread serveThread;            // 应答管理命令的线程
+        std::atomic<bool> isServing{false};
+        std::mutex mtx;                     // 用于保护 shutdownRequested
+        std::condition_variable shutdownCv;
+        bool shutdownRequested = false;
+
+        void serve();
+
+        void takeOverPort();
+
+        [[nodiscard]] std::string handle(const std::string &request);
+
+    public:
+        AdminServer() = delete;
+
+        AdminServer(const AdminServer &) = delete;
+
+        AdminServer(zmq::context_t &context, GameServer &server, uint16_t port = ADMIN_PORT);
+
+        ~AdminServer();
+
+        void start();
+
+        void stop();
+
+        void requestShutdown();
+
+        void waitForShutdown();
+    };
+}
+
+#endif //KINGDOMCARD_ADMINSERVER_H
@@ -1,10 +1,20 @@
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
 #include <memory>
+#include <unistd.h>
 #include "GameServer.h"
+#include "Listener.h"
 #include "basic/Utility.h"
 #include "basic/Player.h"
 #include "basic/GameController.h"
+#include "basic/Snapshot.h"
+#include "basic/BotPlayer.h"
+#include "basic/FrameCompressor.h"
+#include "ai/MctsBotPlayer.h"
 #include "basic_message.pb.h"
 
 // TODO: 切换成利用 monitor 监控连接状态
@@ -13,17 +23,17 @@ namespace kc {
     /// @brief 服务器构造函数
     /// @param context ZeroMQ 上下文
     /// @param port 服务器端口号
-    GameServer::GameServer(zmq::context_t &context, const uint16_t port) : context(context) {
-        potentialPort = port;
+    /// @param shard_count 房间执行器的分片数, 为 0 时每个可用核心一个
+    GameServer::GameServer(zmq::context_t &context, const uint16_t port, size_t shard_count) : context(context) {
+        uint16_t potentialPort = port;
         bridgeRepSocket = zmq::socket_t(context, ZMQ_REP);
         bridgeRepSocket.set(zmq::sockopt::rcvtimeo, 500);
         bool bindSuccess = false;
         while (!bindSuccess) {
             try {
-                // 开放登入端口
-                bridgeRepSocket.bind("tcp://*:" + std::to_string(potentialPort));
+                // 开放登入端口, 与正在排空的旧进程共享
+                bindReusePort(bridgeRepSocket, "*", potentialPort);
                 bindSuccess = true;
-                potentialPort++;
             } catch (zmq::error_t &e) {
                 // 假如失败则端口号+1
                 spdlog::warn("服务器开放端口 {} 失败", potentialPort);
@@ -33,27 +43,46 @@ namespace kc {
                     throw e;
             }
         }
-        spdlog::info("服务器已开放端口: {}", potentialPort - 1);
+        loginPort = potentialPort;
+        nextPort = loginPort + 1;
+        spdlog::info("服务器已开放端口: {}", loginPort);
+        std::vector<int> cpus = Shard::availableCpus();
+        if (shard_count == 0)
+            shard_count = std::max<size_t>(1, cpus.size());
+        for (size_t i = 0; i < shard_count; ++i)
+            shards.emplace_back(std::make_unique<Shard>(i, cpus.empty() ? -1 : cpus[i % cpus.size()]));
+        spdlog::info("房间执行器: {} 个分片, 可用核心数: {}", shard_count, cpus.size());
     }
 
-    /// @brief 服务器析构函数
+    /// @brief 服务器析构函数, ZeroMQ 上下文由调用方关闭
     GameServer::~GameServer() {
         // 等待线程结束
         isWaiting = false;
+        isMatching = false;
+        isResuming = false;
         if (connectionThread.joinable())
             connectionThread.join();
+        if (matchThread.joinable())
+            matchThread.join();
+        if (resumeThread.joinable())
+            resumeThread.join();
+        // 等待进行中的对局结束
+        shards.clear();
         // 关闭所有套接字
+        unpublishIpcLogin();
         bridgeRepSocket.close();
         for (auto &player: players) {
             player->socket.close();
         }
-        context.close();
+        matchmaker.clear();
     }
 
     /// @brief 等待客户端连接
     void GameServer::waitForConnection() {
-        if (isWaiting)
+        if (isWaiting || isDraining)
             return;
+        if (connectionThread.joinable())
+            connectionThread.join();
         spdlog::info("服务器等待客户端连接");
         isWaiting = true;
         connectionThread = std::thread([&]() {
@@ -72,15 +101,19 @@ namespace kc {
                         spdlog::debug("无法解析消息内容, 消息文本为: {}", msg);
                         continue;
                     }
-                    if (parsedMessage.type() == CommandType::CONNECT_REQ) {
+                    if (parsedMessage.type() == CommandType::CONNECT_REQ && isDraining) {
+                        spdlog::info("服务器正在排空, 拒绝连接");
+                        rejectConnection();
+                    } else if (parsedMessage.type() == CommandType::CONNECT_REQ) {
                         spdlog::info("客户端连接, 下发连接信息");
-                        connectWithClient();
+                        connectWithClient(parsedMessage.message());
                     } else
                         spdlog::debug("错误的消息类型: {}", parsedMessage.GetTypeName());
                 } catch (std::exception &e) {
                     spdlog::error("服务器等待连接时发生错误: {}", e.what());
                 }
-                if (players.size() >= waitingPlayerNum)
+                // 匹配模式下大厅不设上限, 等待重连期间继续接受恢复对局的玩家
+                if (!isMatching && !isResuming && lobbySize() >= waitingPlayerNum)
                     isWaiting = false;
             }
             spdlog::debug("结束等待");
@@ -88,34 +121,60 @@ namespace kc {
     }
 
     /// @brief 与客户端建立连接
-    /// @return 玩家对象指针
-    void GameServer::connectWithClient() {
-        bool bindSuccess = false;
-        zmq::socket_t socket(context, ZMQ_PAIR);
-        // 开放与玩家连接的端口
-        while (!bindSuccess) {
-            try {
-                socket.bind("tcp://*:" + std::to_string(potentialPort));
-                // 设置 TCP KeepAlive 检测
-                socket.set(zmq::sockopt::tcp_keepalive, 1);
-                socket.set(zmq::sockopt::tcp_keepalive_cnt, 3);
-                socket.set(zmq::sockopt::tcp_keepalive_idle, 30);
-                socket.set(zmq::sockopt::tcp_keepalive_intvl, 5);
-                bindSuccess = true;
-                potentialPort++;
-            } catch (zmq::error_t &e) {
-                spdlog::warn("服务器开放端口 {} 失败", potentialPort);
-                if (e.num() == EADDRINUSE && potentialPort < 65535)
-                    potentialPort++;
-                else
-                    throw e;
+    /// @param request CONNECT_REQ 的消息内容, 恢复对局时须携带原来的会话令牌
+    void GameServer::connectWithClient(const std::string &request) {
+        ConnectRequest connect_req;
+        connect_req.ParseFromString(request);
+        // 令牌属于等待重连的对局时回到原来的座位并沿用原来的 id, 否则作为新玩家进入大厅或匹配队列
+        uint64_t resume_match = 0;
+        uint32_t player_id = 0;
+        if (connect_req.session_token() != 0) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto token = resumeTokens.find(connect_req.session_token());
+            if (token != resumeTokens.end()) {
+                const PendingResume &pending = resuming.at(token->second);
+                for (size_t seat = 0; seat < pending.snapshot.playerCount; ++seat)
+                    if (pending.snapshot.sessionToken[seat] == token->first)
+                        player_id = pending.snapshot.id[seat];
+                for (const auto &player : pending.rejoined) {
+                    if (player->id == player_id) {
+                        spdlog::warn("玩家 {} 已经重连, 拒绝重复使用的会话令牌", player_id);
+                        rejectConnection();
+                        return;
+                    }
+                }
+                resume_match = token->second;
+            }
+        }
+        if (resume_match == 0) {
+            if (!isMatching && lobbySize() >= waitingPlayerNum) {
+                spdlog::info("大厅已满, 拒绝连接");
+                rejectConnection();
+                return;
             }
+            player_id = assignedId++;
         }
-        spdlog::debug("服务器对玩家 {} 端口: {}", assignedId, potentialPort - 1);
+        zmq::socket_t socket(context, ZMQ_PAIR);
+        uint16_t port = 0;
+        std::string endpoint = bindPlayerSocket(socket, player_id, port);
+        uint64_t token = resume_match != 0 ? connect_req.session_token() : newSessionToken();
+        // 版本一致时才接受紧凑编码, 否则退回 protobuf, 客户端以回复中的 wire_format 为准
+        wire::Format format = connect_req.wire_format() == wire::PACKED && connect_req.wire_version() == wire::VERSION
+                              ? wire::PACKED : wire::PROTOBUF;
+        // 对局中同一时段的多条消息合为一帧, 字典一致时较大的合并帧再压缩
+        bool batch_frames = connect_req.batch_frames();
+        bool zstd_frames = batch_frames
+                           && FrameCompressor::instance().accepts(connect_req.zstd(), connect_req.zstd_dict_id());
         // 发送连接信息
         ConnectResponse connect_r;
-        connect_r.set_port(potentialPort - 1);
-        connect_r.set_player_id(assignedId);
+        if (endpoint.empty())
+            connect_r.set_port(port);
+        connect_r.set_endpoint(endpoint);
+        connect_r.set_player_id(player_id);
+        connect_r.set_session_token(token);
+        connect_r.set_wire_format(format);
+        connect_r.set_batch_frames(batch_frames);
+        connect_r.set_zstd(zstd_frames);
         BasicMessage connect_m;
         connect_m.set_type(CommandType::CONNECT_REP);
         connect_m.set_message(connect_r.SerializeAsString());
@@ -124,12 +183,28 @@ namespace kc {
         bridgeRepSocket.send(connect_msg, zmq::send_flags::none);
         // 验证玩家连接
         socket.set(zmq::sockopt::rcvtimeo, 1000); // 设置超时时间为1s
-        PlayerPtr player = std::make_shared<Player>(assignedId++, std::move(socket));
+        PlayerPtr player = std::make_shared<Player>(player_id, std::move(socket));
+        player->sessionToken = token;
+        player->wireFormat = format;
+        player->batchFrames = batch_frames;
+        player->zstdFrames = zstd_frames;
+        if (connect_req.rating() != 0)
+            player->rating = connect_req.rating();
         util::RecvResult rslt = util::recvCommand(player);
         if (rslt.has_value() && rslt.value() == CommandType::CONNECT_ACK) {
             spdlog::info("玩家 {} 连接成功", player->id);
-            // 创建玩家对象
+            // 恢复对局的玩家回到原来的桌子, 不参与匹配
+            if (resume_match != 0) {
+                rejoin(resume_match, std::move(player));
+                return;
+            }
             std::lock_guard<std::mutex> lock(mtx);
+            if (isMatching) {
+                uint32_t rating = player->rating;
+                matchmaker.enqueue(std::move(player), rating);
+                spdlog::debug("玩家进入匹配队列, 分数: {}, 排队人数: {}", rating, matchmaker.size());
+                return;
+            }
             players.emplace_back(std::move(player));
         } else {
             if (rslt.has_value())
@@ -139,48 +214,471 @@ namespace kc {
         }
     }
 
-    /// @brief 判断服务器是否准备就绪
+    /// @brief 以 KICK 应答登入端口上的连接请求
+    void GameServer::rejectConnection() {
+        BasicMessage kick_m;
+        kick_m.set_type(CommandType::KICK);
+        zmq::message_t kick_msg(kick_m.ByteSizeLong());
+        kick_m.SerializeToArray(kick_msg.data(), static_cast<int>(kick_msg.size()));
+        bridgeRepSocket.send(kick_msg, zmq::send_flags::none);
+    }
+
+    /// @brief 按传输方式为玩家开放连接
+    /// @details TCP 时从上次之后的端口开始依次尝试, 到 65535 后回到登入端口之后, 已关闭的玩家连接的端口由此重新使用;
+    ///          所有端口都被占用时抛出异常
+    /// @param port TCP 时为开放的端口
+    /// @return 客户端应连接的端点, TCP 时为空, 客户端改用服务器地址与 port
+    std::string GameServer::bindPlayerSocket(zmq::socket_t &socket, uint32_t player_id, uint16_t &port) {
+        if (transport == Transport::IPC || transport == Transport::INPROC) {
+            std::string endpoint = transport == Transport::IPC
+                                   ? "ipc://" + ipcDirectory + "/kc-player-" + std::to_string(::getpid()) + "-"
+                                     + std::to_string(player_id) + ".ipc"
+                                   : "inproc://kc-player-" + std::to_string(player_id);
+            socket.bind(endpoint);
+            spdlog::debug("服务器对玩家 {} 端点: {}", player_id, endpoint);
+            return endpoint;
+        }
+        // 开放与玩家连接的端口
+        for (size_t attempt = 0; attempt < static_cast<size_t>(UINT16_MAX - loginPort); ++attempt) {
+            port = nextPort;
+            nextPort = nextPort == UINT16_MAX ? loginPort + 1 : nextPort + 1;
+            try {
+                socket.bind("tcp://*:" + std::to_string(port));
+            } catch (zmq::error_t &e) {
+                if (e.num() != EADDRINUSE)
+                    throw;
+                continue;
+            }
+            // 设置 TCP KeepAlive 检测
+            socket.set(zmq::sockopt::tcp_keepalive, 1);
+            socket.set(zmq::sockopt::tcp_keepalive_cnt, 3);
+            socket.set(zmq::sockopt::tcp_keepalive_idle, 30);
+            socket.set(zmq::sockopt::tcp_keepalive_intvl, 5);
+            spdlog::debug("服务器对玩家 {} 端口: {}", player_id, port);
+            return "";
+        }
+        throw std::runtime_error("没有可用的玩家端口");
+    }
+
+    /// @brief 判断服务器是否准备就绪, 允许机器人补位时至少需要一名真人玩家
     /// @return 服务器是否准备就绪
     bool GameServer::isReady() {
         checkAndKick();
-        return players.size() >= MIN_PLAYER_NUM;
+        std::lock_guard<std::mutex> lock(mtx);
+        return players.size() >= MIN_PLAYER_NUM || (botFill && !players.empty());
     }
 
     /// @brief 检查连通性并踢出掉线的玩家
+    /// @details 在锁外逐个探测大厅玩家, 连接线程可以同时加入新玩家; 掉线的玩家之后按 id 移除
     void GameServer::checkAndKick() {
-        spdlog::debug("检查玩家连通性, 当前玩家数: {}", players.size());
-        recheck:
-        for (auto it = players.begin(); it != players.end(); it++) {
+        std::vector<PlayerPtr> lobby = lobbyPlayers();
+        spdlog::debug("检查玩家连通性, 当前玩家数: {}", lobby.size());
+        std::vector<PlayerPtr> dropped;
+        for (const auto &player : lobby) {
+            if (player->isBot())
+                continue;
             // 发送验证连接请求
-            bool s_rslt = util::sendCommand(*it, CommandType::CONNECT_ACK);
-            util::RecvResult r_rslt = util::recvCommand(*it);
+            bool s_rslt = util::sendCommand(player, CommandType::CONNECT_ACK);
+            util::RecvResult r_rslt = util::recvCommand(player);
             if (!s_rslt || !r_rslt.has_value() || r_rslt.value() != CommandType::CONNECT_ACK) {
                 if (r_rslt.has_value())
-                    spdlog::warn("玩家 {} 掉线, 消息类型错误: {}", (*it)->id, CommandType_Name(r_rslt.value()));
+                    spdlog::warn("玩家 {} 掉线, 消息类型错误: {}", player->id, CommandType_Name(r_rslt.value()));
                 else
-                    spdlog::warn("玩家 {} 掉线, 其他错误原因", (*it)->id);
-                // 踢出掉线玩家 // 掉线了是发不出去的所以不发了
-//                util::sendCommand(*it, CommandType::KICK);
-                std::lock_guard<std::mutex> lock(mtx);
-                std::lock_guard<std::mutex> lock_m((*it)->mtx);
-                (*it)->socket.close();
-                players.erase(it);
-                goto recheck;
+                    spdlog::warn("玩家 {} 掉线, 其他错误原因", player->id);
+                // 掉线了是发不出去的, 不再发送 KICK
+                dropped.push_back(player);
             }
         }
+        if (dropped.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto &player : dropped) {
+                auto it = std::find_if(players.begin(), players.end(),
+                                       [&player](const PlayerPtr &p) { return p->id == player->id; });
+                if (it != players.end())
+                    players.erase(it);
+            }
+        }
+        for (const auto &player : dropped)
+            player->socket.close();
     }
 
-    /// @brief 开始游戏
+    /// @brief 用大厅中的玩家开一桌, 对局在房间线程中进行, 大厅随即重新开放
     void GameServer::start() {
+        if (isDraining)
+            throw std::runtime_error("服务器正在排空, 不再开始新的对局");
         if (!isReady()) {
             throw std::runtime_error("人数不足, 无法开始游戏");
         }
         isWaiting = false;
-        connectionThread.join();
+        if (connectionThread.joinable())
+            connectionThread.join();
+        size_t lobby = lobbySize();
+        if (lobby < MIN_PLAYER_NUM)
+            addBots(MIN_PLAYER_NUM - lobby);
         spdlog::info("开始游戏");
-        // 移交 GameController 控制
-        GameController controller(players);
-        controller.start();
+        std::vector<PlayerPtr> table;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            table.swap(players);
+        }
+        startRoom(newSessionToken(), std::move(table));
+        waitForConnection();
+    }
+
+    /// @brief 把一桌玩家移交给负载最轻的分片, 由分片在它的核心上开始对局
+    /// @param match_id 对局 id
+    /// @param table 桌上的玩家, 之后只由房间线程使用
+    /// @param resumed 有值时从该快照继续对局
+    void GameServer::startRoom(uint64_t match_id, std::vector<PlayerPtr> table,
+                               std::optional<MatchSnapshot> resumed) {
+        RoomRules rules = std::atomic_load(&config)->rulesFor(table.size());
+        RoomAssignment assignment{std::make_shared<Room>(match_id, std::move(table), std::move(rules)),
+                                  snapshots.get(), spectatable ? &context : nullptr, std::move(resumed)};
+        std::lock_guard<std::mutex> lock(dispatchMtx);
+        Shard &shard = **std::min_element(shards.begin(), shards.end(), [](const auto &a, const auto &b) {
+            return a->getLoad() < b->getLoad();
+        });
+        while (!shard.submit(std::move(assignment))) {
+            spdlog::warn("分片 {} 的信箱已满", shard.getIndex());
+            std::this_thread::sleep_for(SHARD_POLL);
+        }
+    }
+
+    /// @brief 汇总各分片房间列表的快照, 其中可能有刚结束而尚未回收的房间
+    std::shared_ptr<const RoomList> GameServer::roomSnapshot() const {
+        auto list = std::make_shared<RoomList>();
+        for (const auto &shard : shards) {
+            auto part = shard->roomSnapshot();
+            list->insert(list->end(), part->begin(), part->end());
+        }
+        return list;
+    }
+
+    /// @brief 解散对局, 房间线程在下一个回合边界向玩家发送 KICK 后结束
+    /// @param match_id 对局 id
+    /// @return 是否找到进行中的对局
+    bool GameServer::destroyRoom(uint64_t match_id) {
+        for (const auto &room : *roomSnapshot()) {
+            if (room->getId() != match_id || room->isFinished())
+                continue;
+            room->requestStop();
+            spdlog::info("请求解散对局 {}", match_id);
+            return true;
+        }
+        return false;
+    }
+
+    /// @brief 进入排空模式: 关闭登入端口, 停止匹配并踢出大厅与队列中的玩家, 进行中的对局照常结束
+    /// @details 登入端口以 SO_REUSEPORT 监听, 关闭后新的连接全部由同端口的新进程接受;
+    ///          还在等待重连的对局不再开始, 快照留在目录中由新进程恢复
+    void GameServer::drain() {
+        if (isDraining.exchange(true))
+            return;
+        isWaiting = false;
+        isMatching = false;
+        isResuming = false;
+        if (connectionThread.joinable())
+            connectionThread.join();
+        if (matchThread.joinable())
+            matchThread.join();
+        if (resumeThread.joinable())
+            resumeThread.join();
+        unpublishIpcLogin();
+        bridgeRepSocket.close();
+        std::vector<PlayerPtr> waiting;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            waiting.swap(players);
+            for (auto &player : matchmaker.takeAll())
+                waiting.emplace_back(std::move(player));
+            for (auto &[match_id, pending] : resuming)
+                for (auto &player : pending.rejoined)
+                    waiting.emplace_back(std::move(player));
+            resuming.clear();
+            resumeTokens.clear();
+        }
+        for (auto &player : waiting) {
+            util::sendCommand(player, CommandType::KICK);
+            player->socket.close();
+        }
+        spdlog::info("服务器进入排空模式, 踢出 {} 名等待中的玩家, 进行中的对局数: {}",
+                     waiting.size(), activeRooms());
+    }
+
+    /// @brief 已分配而未结束的对局数, 包括还在分片信箱中的
+    size_t GameServer::activeRooms() const {
+        size_t active = 0;
+        for (const auto &shard : shards)
+            active += shard->getLoad();
+        return active;
+    }
+
+    /// @brief 阻塞直到所有进行中的对局结束
+    /// @param poll 检查的间隔, 决定最后一局结束后多久返回
+    void GameServer::waitForRooms(std::chrono::milliseconds poll) {
+        size_t last = SIZE_MAX;
+        for (size_t active = activeRooms(); active > 0; active = activeRooms()) {
+            if (active != last)
+                spdlog::info("等待 {} 局对局结束", active);
+            last = active;
+            std::this_thread::sleep_for(poll);
+        }
+    }
+
+    /// @brief 开启匹配: 之后连接的玩家进入匹配队列, 每隔 MATCH_TICK 按分数组桌并各开一个房间
+    /// @param config 匹配参数
+    void GameServer::enableMatchmaking(MatchmakerConfig config) {
+        if (isMatching || isDraining)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            matchmaker = Matchmaker(config);
+        }
+        isMatching = true;
+        spdlog::info("已开启匹配, 每桌 {} 到 {} 人", config.minTable, config.maxTable);
+        matchThread = std::thread([this]() {
+            while (isMatching) {
+                std::this_thread::sleep_for(MATCH_TICK);
+                std::vector<std::vector<PlayerPtr>> tables;
+                size_t queued;
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    tables = matchmaker.tick();
+                    queued = matchmaker.size();
+                }
+                for (auto &table : tables)
+                    startRoom(newSessionToken(), std::move(table));
+                if (!tables.empty())
+                    spdlog::info("匹配成功 {} 桌, 仍在排队: {}", tables.size(), queued);
+            }
+        });
+        // 大厅已满而停止等待时重新开放
+        waitForConnection();
+    }
+
+    /// @brief 替换服务器配置, 只影响之后开始的对局
+    /// @param server_config 新的配置, 其中的端口只在构造服务器时生效
+    /// @param path 配置文件路径, 供 reloadConfig 重新读取
+    void GameServer::setConfig(ServerConfig server_config, const std::string &path) {
+        if (!path.empty())
+            configPath = path;
+        for (const auto &rules : server_config.rooms)
+            spdlog::info("房间规则 {}: {} 到 {} 人, 出牌 {} ms, 反应 {} ms, 牌组 {} 张",
+                         rules.name, rules.minPlayers, rules.maxPlayers,
+                         std::chrono::duration_cast<std::chrono::milliseconds>(rules.turnTimeLimit).count(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(rules.reactTimeLimit).count(),
+                         rules.deckSize());
+        std::atomic_store(&config, std::shared_ptr<const ServerConfig>(
+                std::make_shared<ServerConfig>(std::move(server_config))));
+    }
+
+    /// @brief 重新读取配置文件, 失败时保留原来的配置
+    /// @return 是否成功
+    bool GameServer::reloadConfig() {
+        if (configPath.empty()) {
+            spdlog::warn("没有指定配置文件");
+            return false;
+        }
+        try {
+            ServerConfig loaded = ServerConfig::load(configPath);
+            if (loaded.port != std::atomic_load(&config)->port || loaded.shards != std::atomic_load(&config)->shards
+                || loaded.zstdDictionary != std::atomic_load(&config)->zstdDictionary)
+                spdlog::warn("端口、分片数与 zstd 字典只在启动时读取, 修改须重启服务器");
+            setConfig(std::move(loaded));
+            spdlog::info("已重新加载配置文件 {}", configPath);
+            return true;
+        } catch (std::exception &e) {
+            spdlog::error("重新加载配置失败: {}", e.what());
+            return false;
+        }
+    }
+
+    /// @brief 取得当前配置, 之后重新加载不影响返回的对象
+    std::shared_ptr<const ServerConfig> GameServer::currentConfig() const {
+        return std::atomic_load(&config);
+    }
+
+    /// @brief 凭会话令牌重连的玩家回到等待中的对局, 真人玩家到齐时立即开始
+    /// @param match_id 对局 id
+    /// @param player 已确认连接的玩家
+    void GameServer::rejoin(uint64_t match_id, PlayerPtr player) {
+        std::optional<PendingResume> ready;
+        bool expired = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = resuming.find(match_id);
+            if (it == resuming.end()) {
+                expired = true;
+            } else {
+                it->second.rejoined.emplace_back(player);
+                spdlog::info("玩家 {} 回到对局 {}, 已重连 {}/{}", player->id, match_id,
+                             it->second.rejoined.size(), it->second.humans);
+                if (it->second.rejoined.size() == it->second.humans)
+                    ready = takeResume(it);
+            }
+        }
+        if (expired) {
+            // 握手期间对局已超时开始, 座位由机器人接管
+            spdlog::warn("对局 {} 已经开始, 玩家 {} 未能重连", match_id, player->id);
+            util::sendCommand(player, CommandType::KICK);
+            player->socket.close();
+            return;
+        }
+        if (ready.has_value())
+            resumeWith(std::move(ready.value()));
+    }
+
+    /// @brief 取出等待重连的对局, 其令牌随之失效, 须持有 mtx
+    PendingResume GameServer::takeResume(std::unordered_map<uint64_t, PendingResume>::iterator it) {
+        PendingResume pending = std::move(it->second);
+        resuming.erase(it);
+        for (size_t seat = 0; seat < pending.snapshot.playerCount; ++seat)
+            if (!pending.snapshot.isBot[seat])
+                resumeTokens.erase(pending.snapshot.sessionToken[seat]);
+        return pending;
+    }
+
+    /// @brief 用未完成对局的快照继续游戏, 未重连的真人玩家由机器人接管
+    void GameServer::resumeWith(PendingResume pending) {
+        const MatchSnapshot &snapshot = pending.snapshot;
+        std::vector<PlayerPtr> table = std::move(pending.rejoined);
+        bool mcts;
+        ai::IsmctsConfig config;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            mcts = mctsBots;
+            config = mctsConfig;
+        }
+        for (size_t seat = 0; seat < snapshot.playerCount; ++seat) {
+            bool present = false;
+            for (const auto &player : table)
+                present |= player->id == snapshot.id[seat];
+            if (present)
+                continue;
+            if (!snapshot.isBot[seat])
+                spdlog::warn("玩家 {} 未重连, 由机器人接管", snapshot.id[seat]);
+            if (mcts)
+                table.emplace_back(std::make_shared<MctsBotPlayer>(snapshot.id[seat], config));
+            else
+                table.emplace_back(std::make_shared<BotPlayer>(snapshot.id[seat]));
+        }
+        startRoom(snapshot.matchId, std::move(table), snapshot);
+    }
+
+    /// @brief 生成会话令牌, 也用作对局 id
+    uint64_t GameServer::newSessionToken() {
+        std::lock_guard<std::mutex> lock(tokenMtx);
+        uint64_t token = 0;
+        while (token == 0)
+            token = tokenRng();
+        return token;
+    }
+
+    /// @brief 设置之后连接的玩家使用的传输方式, 须在 waitForConnection 之前调用
+    /// @details 登入端口始终保留 TCP; 选择 IPC 时另在 ipc_directory/kc-server.ipc 开放登入端点,
+    ///          同机的客户端可以完全绕过 TCP 协议栈.
+    ///          ZeroMQ 在绑定与关闭 ipc 端点时都会删除该路径, 新旧进程不能共用同一个文件:
+    ///          每个进程绑定自己的 kc-server-<pid>.ipc, kc-server.ipc 是指向它的符号链接, 以 rename 原子地切换到新进程
+    /// @param scheme 传输方式
+    /// @param ipc_directory ipc:// 端点所在目录
+    void GameServer::setTransport(Transport scheme, const std::string &ipc_directory) {
+        transport = scheme;
+        ipcDirectory = ipc_directory;
+        if (scheme == Transport::INPROC) {
+            bridgeRepSocket.bind("inproc://kc-server");
+            spdlog::info("服务器已开放登入端点: inproc://kc-server");
+        }
+        if (scheme != Transport::IPC)
+            return;
+        std::string own = "kc-server-" + std::to_string(::getpid()) + ".ipc";
+        bridgeRepSocket.bind("ipc://" + ipcDirectory + "/" + own);
+        std::string link = ipcDirectory + "/kc-server.ipc";
+        std::string staging = link + "." + std::to_string(::getpid());
+        ::unlink(staging.c_str());
+        if (::symlink(own.c_str(), staging.c_str()) != 0 || ::rename(staging.c_str(), link.c_str()) != 0) {
+            int err = errno;
+            ::unlink(staging.c_str());
+            throw std::runtime_error("无法发布登入端点 " + link + ": " + std::strerror(err));
+        }
+        ipcLoginLink = link;
+        spdlog::info("服务器已开放登入端点: ipc://{} -> {}", link, own);
+    }
+
+    /// @brief 排空时撤下 kc-server.ipc, 它已指向新进程时保留
+    void GameServer::unpublishIpcLogin() {
+        if (ipcLoginLink.empty())
+            return;
+        std::string own = "kc-server-" + std::to_string(::getpid()) + ".ipc";
+        std::array<char, 256> target{};
+        ssize_t size = ::readlink(ipcLoginLink.c_str(), target.data(), target.size() - 1);
+        if (size > 0 && std::string(target.data(), size) == own)
+            ::unlink(ipcLoginLink.c_str());
+        ipcLoginLink.clear();
+    }
+
+    /// @brief 向 SpectatorHub 发布之后开始的对局, 须与 SpectatorHub 使用同一个 ZeroMQ 上下文
+    void GameServer::enableSpectators() {
+        spectatable = true;
+    }
+
+    /// @brief 在回合边界把对局快照保存到目录中, 并恢复上次未完成的所有对局
+    /// @details 每局等待各自的真人玩家凭会话令牌重连, 到齐或 RESUME_TIMEOUT 后在分片中开始;
+    ///          等待期间新玩家照常进入大厅或匹配队列, 新分配的 id 不与快照中的冲突
+    /// @param directory 快照目录
+    void GameServer::enableSnapshots(const std::string &directory) {
+        snapshots = std::make_unique<SnapshotWriter>(directory);
+        std::vector<MatchSnapshot> found = snapshots->loadAll();
+        auto deadline = std::chrono::steady_clock::now() + RESUME_TIMEOUT;
+        std::vector<PendingResume> ready;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto &snapshot : found) {
+                PendingResume pending{snapshot, {}, 0, deadline};
+                for (size_t seat = 0; seat < snapshot.playerCount; ++seat) {
+                    assignedId = std::max<uint32_t>(assignedId, snapshot.id[seat] + 1);
+                    if (snapshot.isBot[seat])
+                        continue;
+                    ++pending.humans;
+                    resumeTokens[snapshot.sessionToken[seat]] = snapshot.matchId;
+                }
+                spdlog::info("发现对局 {} 第 {} 回合的快照, 等待 {} 名玩家凭会话令牌重连",
+                             snapshot.matchId, snapshot.turn, pending.humans);
+                if (pending.humans == 0)
+                    ready.emplace_back(std::move(pending));
+                else
+                    resuming.emplace(snapshot.matchId, std::move(pending));
+            }
+        }
+        for (auto &pending : ready)
+            resumeWith(std::move(pending));
+        if (resuming.empty() || isResuming)
+            return;
+        isResuming = true;
+        resumeThread = std::thread([this]() {
+            while (isResuming) {
+                std::this_thread::sleep_for(MATCH_TICK);
+                std::vector<PendingResume> due;
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    auto now = std::chrono::steady_clock::now();
+                    for (auto it = resuming.begin(); it != resuming.end();) {
+                        auto next = std::next(it);
+                        if (it->second.deadline <= now)
+                            due.emplace_back(takeResume(it));
+                        it = next;
+                    }
+                    if (resuming.empty())
+                        isResuming = false;
+                }
+                for (auto &pending : due) {
+                    spdlog::warn("对局 {} 等待重连超时, 已重连 {}/{}", pending.snapshot.matchId,
+                                 pending.rejoined.size(), pending.humans);
+                    resumeWith(std::move(pending));
+                }
+            }
+        });
     }
 
     /// @brief 设置等待玩家人数
@@ -189,29 +687,77 @@ namespace kc {
         waitingPlayerNum = num;
     }
 
-    /// @brief 列出所有玩家
-    void GameServer::listPlayers() {
-        spdlog::info("当前玩家数: {}", players.size());
-        for (auto &player: players) {
-            spdlog::info("玩家 ID: {}", player->id);
+    /// @brief 设置人数不足时是否用机器人补齐
+    void GameServer::setBotFill(bool fill) {
+        botFill = fill;
+    }
+
+    /// @brief 添加机器人玩家
+    /// @param num 机器人数量
+    void GameServer::addBots(uint16_t num) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (uint16_t i = 0; i < num && players.size() < MAX_PLAYER_NUM; ++i) {
+            if (mctsBots)
+                players.emplace_back(std::make_shared<MctsBotPlayer>(assignedId++, mctsConfig));
+            else
+                players.emplace_back(std::make_shared<BotPlayer>(assignedId++));
+            spdlog::info("机器人 {} 加入游戏", players.back()->id);
         }
     }
 
-    /// @brief 踢出玩家
+    /// @brief 设置补位机器人是否使用 ISMCTS
+    /// @param enable 是否启用
+    /// @param budget 每次决策的时间预算
+    /// @param threads 搜索线程数
+    void GameServer::setMctsBots(bool enable, std::chrono::milliseconds budget, size_t threads) {
+        std::lock_guard<std::mutex> lock(mtx);
+        mctsBots = enable;
+        mctsConfig.budget = budget;
+        mctsConfig.threads = threads;
+    }
+
+    /// @brief 取得大厅中的玩家
+    std::vector<PlayerPtr> GameServer::lobbyPlayers() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return players;
+    }
+
+    /// @brief 取得大厅人数
+    size_t GameServer::lobbySize() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return players.size();
+    }
+
+    /// @brief 取得匹配队列人数
+    size_t GameServer::queueSize() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return matchmaker.size();
+    }
+
+    /// @brief 踢出大厅或匹配队列中的玩家, 已入座的玩家须解散其对局
     /// @param player_id 玩家 ID
-    void GameServer::kickPlayer(uint16_t player_id) {
-        for (auto it = players.begin(); it != players.end(); it++) {
-            if ((*it)->id == player_id) {
-                util::sendCommand(*it, CommandType::KICK);
-                std::lock_guard<std::mutex> lock(mtx);
-                std::lock_guard<std::mutex> lock_m((*it)->mtx);
-                (*it)->socket.close();
+    /// @return 是否找到该玩家
+    bool GameServer::kickPlayer(uint32_t player_id) {
+        PlayerPtr player;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = std::find_if(players.begin(), players.end(),
+                                   [player_id](const PlayerPtr &p) { return p->id == player_id; });
+            if (it != players.end()) {
+                player = *it;
                 players.erase(it);
-                spdlog::info("玩家 {} 已被踢出", player_id);
-                return;
+            } else {
+                player = matchmaker.remove(player_id);
             }
         }
-        spdlog::warn("玩家 {} 不存在", player_id);
+        if (player == nullptr) {
+            spdlog::warn("玩家 {} 不存在", player_id);
+            return false;
+        }
+        util::sendCommand(player, CommandType::KICK);
+        player->socket.close();
+        spdlog::info("玩家 {} 已被踢出", player_id);
+        return true;
     }
 }
 
@@ -2,45 +2,156 @@
 #ifndef KINGDOMCARD_GAMESERVER_H
 #define KINGDOMCARD_GAMESERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <random>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 #include <zmq.hpp>
+#include "basic/Matchmaker.h"
 #include "basic/Player.h"
+#include "basic/Room.h"
+#include "basic/ServerConfig.h"
+#include "basic/Shard.h"
+#include "basic/SnapshotWriter.h"
+#include "ai/Ismcts.h"
 
 namespace kc {
+    std::chrono::milliseconds const MATCH_TICK(500);   // 匹配器组桌的间隔
+    std::chrono::seconds const RESUME_TIMEOUT(60);      // 重启后等待玩家重连的时间, 超时后未重连的座位由机器人接管
+
+    /// @brief 玩家连接使用的传输方式
+    enum class Transport {
+        TCP,        // tcp://, 默认, 可跨主机
+        IPC,        // ipc://, Unix 域套接字, 用于与服务器同机的客户端
+        INPROC      // inproc://, 仅用于与服务器同进程且共享 ZeroMQ 上下文的客户端
+    };
+
+    /// @brief 重启后等待玩家凭会话令牌重连的未完成对局
+    struct PendingResume {
+        MatchSnapshot snapshot;
+        std::vector<PlayerPtr> rejoined;    // 已重连的真人玩家
+        size_t humans = 0;                  // 快照中的真人玩家数, 全部重连后立即开始
+        std::chrono::steady_clock::time_point deadline;
+    };
+
     class GameServer {
     private:
         zmq::context_t &context;
         zmq::socket_t bridgeRepSocket;      // 用于通告客户端连接的套接字
         std::thread connectionThread;       // 用于等待客户端连接的线程
-        std::vector<PlayerPtr> players;     // 玩家列表
-        std::mutex mtx;                     // 用于保护玩家列表的互斥量
-        uint16_t potentialPort;
-        bool isWaiting = false;
-        uint16_t assignedId = 0;
-        uint16_t waitingPlayerNum = MAX_PLAYER_NUM;
+        std::vector<PlayerPtr> players;     // 大厅中等待手动开局的玩家
+        std::mutex mtx;                     // 用于保护玩家列表与匹配队列的互斥量
+        uint16_t loginPort = 0;
+        uint16_t nextPort = 0;              // 下一个尝试开放的玩家端口, 只由连接线程使用
+        std::atomic<bool> isWaiting{false};
+        std::atomic<uint32_t> assignedId{0};  // 连接线程与管理线程都会分配 id
+        std::atomic<uint16_t> waitingPlayerNum{MAX_PLAYER_NUM};  // 管理线程修改, 连接线程读取
+        std::atomic<bool> botFill{true};    // 人数不足时是否用机器人补齐
+        bool mctsBots = false;              // 补位机器人是否使用 ISMCTS, 受 mtx 保护
+        ai::IsmctsConfig mctsConfig;        // ISMCTS 机器人的搜索参数, 受 mtx 保护
+        std::mt19937_64 tokenRng{std::random_device()()};
+        std::mutex tokenMtx;
+        std::unique_ptr<SnapshotWriter> snapshots;  // 为空时不保存快照
+        std::unordered_map<uint64_t, PendingResume> resuming;  // 对局 id -> 等待重连的对局, 受 mtx 保护
+        std::unordered_map<uint64_t, uint64_t> resumeTokens;   // 会话令牌 -> 对局 id, 受 mtx 保护
+        std::thread resumeThread;                   // 超时后开始未等齐的对局
+        std::atomic<bool> isResuming{false};
+        bool spectatable = false;                   // 是否向 SpectatorHub 发布观战事件
+        Transport transport = Transport::TCP;
+        std::string ipcDirectory = "/tmp";          // ipc:// 端点所在目录
+        std::string ipcLoginLink;                   // 本进程发布的 kc-server.ipc 符号链接, 未发布时为空
+        Matchmaker matchmaker;                      // 开启匹配后新连接的玩家在此排队
+        std::thread matchThread;                    // 定时组桌的线程
+        std::atomic<bool> isMatching{false};
+        std::atomic<bool> isDraining{false};        // 排空时不再接受连接与开局
+        std::vector<std::unique_ptr<Shard>> shards; // 每个核心一个房间执行器
+        std::mutex dispatchMtx;                     // 串行化向分片信箱的投递, 使每个信箱只有一个生产者
+        // 以 std::atomic_load / std::atomic_store 整体替换, 开局时读取
+        std::shared_ptr<const ServerConfig> config = std::make_shared<const ServerConfig>();
+        std::string configPath;
+
+        [[nodiscard]] std::string bindPlayerSocket(zmq::socket_t &socket, uint32_t player_id, uint16_t &port);
+
+        [[nodiscard]] uint64_t newSessionToken();
+
+        void rejectConnection();
+
+        void unpublishIpcLogin();
+
+        void rejoin(uint64_t match_id, PlayerPtr player);
+
+        [[nodiscard]] PendingResume takeResume(std::unordered_map<uint64_t, PendingResume>::iterator it);
+
+        void resumeWith(PendingResume pending);
+
+        void startRoom(uint64_t match_id, std::vector<PlayerPtr> table,
+                       std::optional<MatchSnapshot> resumed = std::nullopt);
     public:
         GameServer() = delete;
 
         GameServer(const GameServer &) = delete;
 
-        GameServer(zmq::context_t &context, uint16_t port);
+        GameServer(zmq::context_t &context, uint16_t port, size_t shard_count = 0);
 
         ~GameServer();
 
         void waitForConnection();
 
-        void connectWithClient();
+        void connectWithClient(const std::string &request);
 
         [[nodiscard]] bool isReady();
         void checkAndKick();
 
-        void listPlayers();
+        [[nodiscard]] std::vector<PlayerPtr> lobbyPlayers();
 
-        void kickPlayer(uint16_t player_id);
+        [[nodiscard]] size_t lobbySize();
+
+        [[nodiscard]] size_t queueSize();
+
+        bool kickPlayer(uint32_t player_id);
 
         void setWaitingPlayerNum(uint16_t num);
 
+        void setBotFill(bool fill);
+
+        void addBots(uint16_t num);
+
+        void setMctsBots(bool enable, std::chrono::milliseconds budget, size_t threads);
+
+        void enableSnapshots(const std::string &directory);
+
+        void enableSpectators();
+
+        void setTransport(Transport scheme, const std::string &ipc_directory = "/tmp");
+
+        void enableMatchmaking(MatchmakerConfig config = {});
+
+        void setConfig(ServerConfig server_config, const std::string &path = "");
+
+        bool reloadConfig();
+
+        [[nodiscard]] std::shared_ptr<const ServerConfig> currentConfig() const;
+
+        [[nodiscard]] std::shared_ptr<const RoomList> roomSnapshot() const;
+
+        bool destroyRoom(uint64_t match_id);
+
+        void drain();
+
+        [[nodiscard]] size_t activeRooms() const;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Shard>> &getShards() const { return shards; }
+
+        void waitForRooms(std::chrono::milliseconds poll = std::chrono::milliseconds(200));
+
+        [[nodiscard]] bool isDrainMode() const { return isDraining; }
+
+        [[nodiscard]] bool isMatchmaking() const { return isMatching; }
+
         void start();
     };
 }
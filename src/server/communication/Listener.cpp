@@ -0,0 +1,67 @@
+#include "Listener.h"
+
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace kc {
+    /// @brief 以 SO_REUSEPORT 打开 TCP 监听套接字, 经 ZMQ_USE_FD 交给 ZeroMQ 套接字
+    /// @details 新旧两个 kc_server 进程可以同时监听同一端口: 新进程启动后即可接受连接,
+    ///          旧进程排空时关闭自己的监听套接字, 之后的连接全部由新进程接受
+    /// @param socket 要绑定的 ZeroMQ 套接字
+    /// @param host "*" 表示所有地址, 否则为 IPv4 地址
+    /// @param port 端口号
+    /// @throw zmq::error_t 端口被不允许共享的进程占用时 num() 为 EADDRINUSE
+    void bindReusePort(zmq::socket_t &socket, const std::string &host, uint16_t port) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw zmq::error_t();
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (host != "*" && ::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            ::close(fd);
+            errno = EINVAL;
+            throw zmq::error_t();
+        }
+        int on = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0
+            || ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0
+            || ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+            || ::listen(fd, SOMAXCONN) != 0) {
+            int err = errno;
+            ::close(fd);
+            errno = err;
+            throw zmq::error_t();
+        }
+        try {
+            // 之后由 ZeroMQ 负责关闭 fd
+            socket.set(zmq::sockopt::use_fd, fd);
+            socket.bind("tcp://" + host + ":" + std::to_string(port));
+        } catch (zmq::error_t &) {
+            ::close(fd);
+            throw;
+        }
+        // 不影响同一套接字之后的其他端点
+        socket.set(zmq::sockopt::use_fd, -1);
+    }
+
+    /// @brief 独占地绑定端点, 不与其他进程共享; 只有登入端口以 bindReusePort 共享
+    /// @details 交接期间管理、指标与观战端口仍属于旧进程, 新进程之后重试, 旧进程释放后再接管,
+    ///          这样同一时刻发往这些端口的请求只会到达一个进程
+    /// @return 端口被占用时为 false
+    /// @throw zmq::error_t 其他错误
+    bool bindIfFree(zmq::socket_t &socket, const std::string &endpoint) {
+        try {
+            socket.bind(endpoint);
+        } catch (zmq::error_t &e) {
+            if (e.num() != EADDRINUSE)
+                throw;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,14 @@
+
+#ifndef KINGDOMCARD_LISTENER_H
+#define KINGDOMCARD_LISTENER_H
+
+#include <string>
+#include <zmq.hpp>
+
+namespace kc {
+    void bindReusePort(zmq::socket_t &socket, const std::string &host, uint16_t port);
+
+    bool bindIfFree(zmq::socket_t &socket, const std::string &endpoint);
+}
+
+#endif //KINGDOMCARD_LISTENER_H
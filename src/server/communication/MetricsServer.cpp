@@ -0,0 +1,85 @@
+#include <spdlog/spdlog.h>
+
+#include "MetricsServer.h"
+#include "Listener.h"
+#include "basic/Metrics.h"
+
+namespace kc {
+    /// @brief 指标服务构造函数
+    /// @param context ZeroMQ 上下文
+    /// @param port 指标端口号
+    MetricsServer::MetricsServer(zmq::context_t &context, const uint16_t port) {
+        streamSocket = zmq::socket_t(context, ZMQ_STREAM);
+        streamSocket.set(zmq::sockopt::rcvtimeo, 500);
+        streamSocket.set(zmq::sockopt::linger, 0);
+        endpoint = "tcp://127.0.0.1:" + std::to_string(port);
+        takeOverPort();
+        if (!isBound)
+            spdlog::warn("指标端口 {} 被占用, 可能属于正在交接的旧进程, 之后重试", port);
+    }
+
+    /// @brief 尝试绑定指标端口, 已绑定时不做任何事
+    void MetricsServer::takeOverPort() {
+        if (isBound || !bindIfFree(streamSocket, endpoint))
+            return;
+        isBound = true;
+        spdlog::info("指标服务已开放端点: {}", endpoint);
+    }
+
+    /// @brief 指标服务析构函数
+    MetricsServer::~MetricsServer() {
+        stop();
+        streamSocket.close();
+    }
+
+    /// @brief 开始响应抓取请求
+    void MetricsServer::start() {
+        if (isServing)
+            return;
+        isServing = true;
+        serveThread = std::thread(&MetricsServer::serve, this);
+    }
+
+    /// @brief 停止响应抓取请求
+    void MetricsServer::stop() {
+        isServing = false;
+        if (serveThread.joinable())
+            serveThread.join();
+    }
+
+    /// @brief 响应循环, 每个连接只处理一次请求后即关闭
+    void MetricsServer::serve() {
+        while (isServing) {
+            try {
+                takeOverPort();
+                zmq::message_t identity;
+                zmq::message_t request;
+                if (!streamSocket.recv(identity).has_value())
+                    continue;
+                if (!streamSocket.recv(request).has_value() || request.size() == 0)
+                    continue;   // 连接建立或断开的通知
+                std::string body;
+                std::string status;
+                if (request.to_string().rfind("GET /metrics", 0) == 0) {
+                    status = "200 OK";
+                    body = metrics::Registry::instance().exposition();
+                } else {
+                    status = "404 Not Found";
+                    body = "not found\n";
+                }
+                std::string response = "HTTP/1.1 " + status + "\r\n"
+                                       "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                       "Connection: close\r\n\r\n" + body;
+                zmq::message_t response_msg(response.data(), response.size());
+                streamSocket.send(zmq::message_t(identity.data(), identity.size()), zmq::send_flags::sndmore);
+                streamSocket.send(response_msg, zmq::send_flags::none);
+                // 发送空帧以关闭连接
+                streamSocket.send(zmq::message_t(identity.data(), identity.size()), zmq::send_flags::sndmore);
+                streamSocket.send(zmq::message_t(), zmq::send_flags::none);
+            } catch (std::exception &e) {
+                spdlog::error("指标服务响应失败: {}", e.what());
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef KINGDOMCARD_METRICSSERVER_H
+#define KINGDOMCARD_METRICSSERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+
+namespace kc {
+    /// @brief 以 HTTP 形式导出 Prometheus 指标, 只监听本地回环地址
+    class MetricsServer {
+    private:
+        zmq::socket_t streamSocket;         // ZMQ_STREAM 套接字, 直接收发原始 TCP 数据
+        std::string endpoint;
+        bool isBound = false;               // 端口被交接中的旧进程占用时为 false, 之后重试
+        std::thread serveThread;            // 响应抓取请求的线程
+        std::atomic<bool> isServing{false};
+
+        void serve();
+
+        void takeOverPort();
+
+    public:
+        MetricsServer() = delete;
+
+        MetricsServer(const MetricsServer &) = delete;
+
+        MetricsServer(zmq::context_t &context, uint16_t port);
+
+        ~MetricsServer();
+
+        void start();
+
+        void stop();
+    };
+}
+
+#endif //KINGDOMCARD_METRICSSERVER_H
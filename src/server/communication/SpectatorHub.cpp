@@ -0,0 +1,111 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include "SpectatorHub.h"
+#include "Listener.h"
+#include "basic/SpectatorFeed.h"
+
+namespace kc {
+    /// @brief 观战代理构造函数
+    /// @param context ZeroMQ 上下文, 须与各对局的 SpectatorFeed 相同
+    /// @param port 观众连接的端口号
+    /// @param delay 事件公开前的延迟
+    SpectatorHub::SpectatorHub(zmq::context_t &context, const uint16_t port, std::chrono::milliseconds delay)
+            : delay(delay) {
+        subSocket = zmq::socket_t(context, ZMQ_SUB);
+        subSocket.set(zmq::sockopt::subscribe, "");
+        subSocket.set(zmq::sockopt::linger, 0);
+        subSocket.bind(SPECTATOR_ENDPOINT);
+        pubSocket = zmq::socket_t(context, ZMQ_XPUB);
+        pubSocket.set(zmq::sockopt::linger, 0);
+        pubSocket.set(zmq::sockopt::sndhwm, 10000);     // 慢速观众超出后丢弃, 不影响其他观众
+        endpoint = "tcp://*:" + std::to_string(port);
+        takeOverPort();
+        if (!isBound)
+            spdlog::warn("观战端口 {} 被占用, 可能属于正在交接的旧进程, 之后重试", port);
+        spdlog::info("观战延迟 {} ms", delay.count());
+    }
+
+    /// @brief 尝试绑定观战端口, 已绑定时不做任何事
+    void SpectatorHub::takeOverPort() {
+        if (isBound || !bindIfFree(pubSocket, endpoint))
+            return;
+        isBound = true;
+        spdlog::info("观战服务已开放端点: {}", endpoint);
+    }
+
+    /// @brief 观战代理析构函数
+    SpectatorHub::~SpectatorHub() {
+        stop();
+        subSocket.close();
+        pubSocket.close();
+    }
+
+    /// @brief 开始转发
+    void SpectatorHub::start() {
+        if (isServing)
+            return;
+        isServing = true;
+        proxyThread = std::thread(&SpectatorHub::proxy, this);
+    }
+
+    /// @brief 停止转发, 尚未公开的事件被丢弃
+    void SpectatorHub::stop() {
+        isServing = false;
+        if (proxyThread.joinable())
+            proxyThread.join();
+    }
+
+    /// @brief 转发循环: 收下新事件, 公开到期的事件, 并记录观众的订阅变化
+    void SpectatorHub::proxy() {
+        zmq::pollitem_t items[] = {
+                {subSocket, 0, ZMQ_POLLIN, 0},
+                {pubSocket, 0, ZMQ_POLLIN, 0}
+        };
+        while (isServing) {
+            // 等到下一个事件到期, 至多 100 ms 以便响应 stop
+            auto timeout = std::chrono::milliseconds(100);
+            if (!pending.empty()) {
+                auto until = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        pending.front().releaseTime - std::chrono::steady_clock::now());
+                timeout = std::clamp(until, std::chrono::milliseconds(0), timeout);
+            }
+            try {
+                takeOverPort();
+                zmq::poll(items, 2, timeout);
+                if (items[0].revents & ZMQ_POLLIN) {
+                    Event event;
+                    while (subSocket.recv(event.topic, zmq::recv_flags::dontwait).has_value()) {
+                        if (!event.topic.more() || !subSocket.recv(event.payload).has_value())
+                            continue;
+                        event.releaseTime = std::chrono::steady_clock::now() + delay;
+                        pending.emplace_back(std::move(event));
+                    }
+                }
+                if (items[1].revents & ZMQ_POLLIN) {
+                    zmq::message_t subscription;
+                    while (pubSocket.recv(subscription, zmq::recv_flags::dontwait).has_value()) {
+                        if (subscription.size() == 0)
+                            continue;
+                        bool subscribe = static_cast<const uint8_t *>(subscription.data())[0] == 1;
+                        if (subscribe)
+                            ++subscriptions;
+                        else if (subscriptions > 0)
+                            --subscriptions;
+                        spdlog::debug("观众{}订阅 \"{}\", 当前订阅数: {}", subscribe ? "" : "取消",
+                                      std::string(static_cast<const char *>(subscription.data()) + 1,
+                                                  subscription.size() - 1), subscriptions);
+                    }
+                }
+                auto now = std::chrono::steady_clock::now();
+                while (!pending.empty() && pending.front().releaseTime <= now) {
+                    pubSocket.send(pending.front().topic, zmq::send_flags::sndmore);
+                    pubSocket.send(pending.front().payload, zmq::send_flags::none);
+                    pending.pop_front();
+                }
+            } catch (zmq::error_t &e) {
+                spdlog::error("观战服务转发失败: {}", e.what());
+            }
+        }
+    }
+}
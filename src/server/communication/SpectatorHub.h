@@ -0,0 +1,52 @@
+#ifndef KINGDOMCARD_SPECTATORHUB_H
+#define KINGDOMCARD_SPECTATORHUB_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+
+namespace kc {
+    /// @brief 观战代理: 汇集所有对局的 SpectatorFeed, 延迟一段时间后经 XPUB 扇出给观众
+    /// @details 游戏线程只向 inproc 地址发送一次, 观众的数量、慢速观众与延迟队列都只影响本线程;
+    ///          观众用 SUB 套接字连接端口, 订阅 "match-<id>/" 观看某一局, 订阅空串观看所有对局
+    class SpectatorHub {
+    private:
+        struct Event {
+            std::chrono::steady_clock::time_point releaseTime;
+            zmq::message_t topic;
+            zmq::message_t payload;
+        };
+
+        zmq::socket_t subSocket;            // 绑定 SPECTATOR_ENDPOINT, 接收各对局的事件
+        zmq::socket_t pubSocket;            // ZMQ_XPUB, 面向观众
+        std::string endpoint;
+        bool isBound = false;               // 端口被交接中的旧进程占用时为 false, 之后重试
+        std::chrono::milliseconds delay;    // 事件公开前的延迟, 防止观战者向玩家通风报信
+        std::deque<Event> pending;          // 按到达顺序排列, 也即按公开时间排列
+        std::thread proxyThread;
+        std::atomic<bool> isServing{false};
+        size_t subscriptions = 0;
+
+        void proxy();
+
+        void takeOverPort();
+
+    public:
+        SpectatorHub() = delete;
+
+        SpectatorHub(const SpectatorHub &) = delete;
+
+        SpectatorHub(zmq::context_t &context, uint16_t port, std::chrono::milliseconds delay);
+
+        ~SpectatorHub();
+
+        void start();
+
+        void stop();
+    };
+}
+
+#endif //KINGDOMCARD_SPECTATORHUB_H
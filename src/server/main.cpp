@@ -1,49 +1,72 @@
 #include <zmq.hpp>
 #include <spdlog/spdlog.h>
+#include <csignal>
+#include <cstdlib>
 #include <string>
-#include <iostream>
+#include <thread>
+#include "basic/FrameCompressor.h"
+#include "communication/AdminServer.h"
 #include "communication/GameServer.h"
+#include "communication/MetricsServer.h"
+#include "communication/SpectatorHub.h"
 
-int main()
+/// @brief kc_server [tcp|ipc] [配置文件], ipc 时同机的客户端经 Unix 域套接字连接, 配置文件默认为 kc_server.conf
+int main(int argc, char **argv)
 {
     spdlog::set_level(spdlog::level::debug);
+    // SIGINT 与 SIGTERM 只由下面的信号线程接收
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::string config_path = argc > 2 ? argv[2] : "kc_server.conf";
+    kc::ServerConfig config;
+    try {
+        config = kc::ServerConfig::load(config_path);
+    } catch (std::exception &e) {
+        spdlog::warn("{}, 使用默认配置", e.what());
+    }
+    if (!config.zstdDictionary.empty()) {
+        try {
+            kc::FrameCompressor::instance().loadDictionary(config.zstdDictionary);
+        } catch (std::exception &e) {
+            spdlog::warn("{}, 合并帧不使用字典", e.what());
+        }
+    }
     zmq::context_t context(1);
-    kc::GameServer server(context, 13364);
+    kc::GameServer server(context, config.port, config.shards);
+    server.setConfig(config, config_path);
+    if (argc > 1 && std::string(argv[1]) == "ipc")
+        server.setTransport(kc::Transport::IPC);
+    else if (argc > 1 && std::string(argv[1]) != "tcp")
+        spdlog::warn("未知的传输方式: {}, 使用 tcp", argv[1]);
+    kc::MetricsServer metrics(context, 13363);
+    metrics.start();
+    kc::SpectatorHub spectators(context, 13362, std::chrono::seconds(5));
+    spectators.start();
+    server.enableSpectators();
+    server.enableSnapshots("snapshots");
     server.waitForConnection();
     spdlog::info("等待连接成功");
-    spdlog::info("可用命令:\n"
-                 "\tstart: 立即开始游戏\n"
-                 "\tmax <start_num>: 最大等待人数\n"
-                 "\tlist: 列出所有玩家\n"
-                 "\tcheck: 检查玩家是否在线\n"
-                 "\tkick <player_id>: 踢出玩家 player_id\n"
-                 "\texit: 退出服务器");
-    std::string command;
-    while (std::cin >> command) {
-        if (command == "start") {
-            if (server.isReady()) {
-                server.start();
-                break;
-            } else {
-                spdlog::error("玩家人数不足");
-            }
-        } else if (command == "max") {
-            unsigned start_num;
-            std::cin >> start_num;
-            server.setWaitingPlayerNum(start_num);
-        } else if (command == "list") {
-            server.listPlayers();
-        } else if (command == "check") {
-            server.checkAndKick();
-        } else if (command == "kick") {
-            int player_id;
-            std::cin >> player_id;
-            server.kickPlayer(player_id);
-        } else if (command == "exit") {
-            break;
-        } else {
-            spdlog::warn("未知命令: {}", command);
-        }
-    }
+    kc::AdminServer admin(context, server);
+    admin.start();
+    spdlog::info("管理命令经 tcp://127.0.0.1:{} 或本进程的 ipc 端点下发, 例如 kc_test_client admin help", kc::ADMIN_PORT);
+    // 第一次收到信号时排空, 第二次立即退出, 未结束的对局留下快照
+    std::thread([&admin, signals]() {
+        int sig;
+        sigwait(&signals, &sig);
+        spdlog::info("收到信号 {}, 开始排空", sig);
+        admin.requestShutdown();
+        sigwait(&signals, &sig);
+        spdlog::warn("再次收到信号 {}, 立即退出", sig);
+        std::_Exit(EXIT_FAILURE);
+    }).detach();
+    admin.waitForShutdown();
+    // 先释放管理端口与登入端口, 新进程随即接管, 本进程只等待剩余对局
+    admin.stop();
+    server.drain();
+    server.waitForRooms();
+    spdlog::info("所有对局已结束, 退出服务器");
     return 0;
 }
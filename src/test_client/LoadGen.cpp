@@ -0,0 +1,544 @@
+#include "LoadGen.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <spdlog/spdlog.h>
+#ifdef KC_WITH_ZSTD
+#include <zstd.h>
+#endif
+#include "basic_message.pb.h"
+#include "command.pb.h"
+
+namespace loadgen {
+    namespace {
+        // 各回合类型可出的牌, 以 CardType_pb 为位序, 与服务端 TurnCardsAvailable 一致
+        uint32_t const TurnCardMask[] = {
+                (1u << SLASH) | (1u << DISMANTLE) | (1u << STEAL) | (1u << ARCHERY_VOLLEY) | (1u << BARBARIAN)
+                | (1u << SLEIGHT_OF_HAND) | (1u << HARVEST_FEAST) | (1u << PEACH) | (1u << PEACH_GARDEN_OATH)
+                | (1u << DUEL),
+                (1u << UNRELENTING),
+                (1u << UNRELENTING) | (1u << SLASH),
+                (1u << UNRELENTING) | (1u << DODGE),
+                (1u << SLASH),
+                (1u << DODGE),
+                (1u << PEACH) | (1u << PEACH_GARDEN_OATH)
+        };
+
+        bool needsTarget(int type) {
+            return type == SLASH || type == DISMANTLE || type == STEAL || type == DUEL;
+        }
+
+        void send(zmq::socket_t &socket, CommandType type, uint32_t player_id, const std::string &msg) {
+            BasicMessage m;
+            m.set_type(type);
+            m.set_player_id(player_id);
+            m.set_message(msg);
+            zmq::message_t z(m.ByteSizeLong());
+            m.SerializeToArray(z.data(), static_cast<int>(z.size()));
+            socket.send(z, zmq::send_flags::dontwait);
+        }
+
+        uint32_t micros(std::chrono::steady_clock::duration d) {
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+        }
+
+        void sendPacked(zmq::socket_t &socket, CommandType type, uint32_t player_id, const std::string &body) {
+            std::string frame;
+            wire::appendHeader(frame, static_cast<uint8_t>(type), player_id);
+            frame += body;
+            zmq::message_t z(frame.data(), frame.size());
+            socket.send(z, zmq::send_flags::dontwait);
+        }
+
+        /// @brief 取出一帧消息的类型与消息体; 紧凑编码时消息体指向帧内, 否则指向 envelope
+        bool unwrap(const Bot &bot, const char *data, size_t size, BasicMessage &envelope,
+                    CommandType &type, std::string_view &body) {
+            if (bot.packed) {
+                const wire::Header *header = wire::header(data, size);
+                if (header == nullptr)
+                    return false;
+                type = static_cast<CommandType>(header->type);
+                body = std::string_view(data + sizeof(wire::Header), size - sizeof(wire::Header));
+                return true;
+            }
+            if (!envelope.ParseFromArray(data, static_cast<int>(size)))
+                return false;
+            type = envelope.type();
+            body = envelope.message();
+            return true;
+        }
+
+        /// @brief 原地读取紧凑编码的 CardList, 格式错误时为 nullptr
+        const wire::Card *viewCards(std::string_view body, size_t &count) {
+            const auto *list = wire::view<wire::CardList>(body.data(), body.size());
+            if (list == nullptr)
+                return nullptr;
+            count = list->count;
+            return wire::viewArray<wire::Card>(body.data(), body.size(), sizeof(wire::CardList), count);
+        }
+
+        void ackConnection(Bot &bot) {
+            if (bot.packed)
+                sendPacked(bot.socket, CommandType::CONNECT_ACK, bot.id, "");
+            else
+                send(bot.socket, CommandType::CONNECT_ACK, bot.id, std::to_string(bot.id));
+        }
+
+        /// @brief 填入本地时刻后带回服务器的时钟同步探测
+        /// @return 之后还有几轮
+        uint32_t answerClockSync(Bot &bot, std::string_view body) {
+            auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            if (bot.packed) {
+                const auto *probe = wire::view<wire::ClockSync>(body.data(), body.size());
+                if (probe == nullptr)
+                    return 0;
+                wire::ClockSync sync = *probe;
+                sync.clientTime = now;
+                std::string reply;
+                wire::append(reply, sync);
+                sendPacked(bot.socket, CommandType::CLOCK_SYNC, bot.id, reply);
+                return sync.remainingRounds;
+            }
+            ClockSync sync;
+            sync.ParseFromArray(body.data(), static_cast<int>(body.size()));
+            sync.set_client_time(now);
+            send(bot.socket, CommandType::CLOCK_SYNC, bot.id, sync.SerializeAsString());
+            return sync.remaining_rounds();
+        }
+
+        void removeFromHand(Bot &bot, uint32_t card_id) {
+            bot.hand.erase(std::remove_if(bot.hand.begin(), bot.hand.end(),
+                                          [&](const auto &c) { return c.first == card_id; }),
+                           bot.hand.end());
+        }
+
+        void onPlayerState(Bot &bot, uint32_t id, uint32_t hp, uint32_t max_hp) {
+            if (id == bot.id) {
+                bot.hp = hp;
+                bot.maxHp = max_hp;
+            } else {
+                bot.others.emplace_back(id, hp);
+            }
+        }
+
+        void onNoticeCard(Bot &bot, uint32_t card_id, Stats &stats) {
+            if (bot.pendingCardId >= 0 && card_id == static_cast<uint32_t>(bot.pendingCardId)) {
+                auto now = std::chrono::steady_clock::now();
+                stats.playRtt.emplace_back(micros(now - bot.playTime));
+                stats.turnRtt.emplace_back(micros(now - bot.turnTime));
+                bot.pendingCardId = -1;
+            }
+        }
+
+        uint32_t percentile(const std::vector<uint32_t> &sorted, double p) {
+            if (sorted.empty())
+                return 0;
+            auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+            return sorted[idx];
+        }
+    }
+
+    LoadGenerator::~LoadGenerator() {
+#ifdef KC_WITH_ZSTD
+        ZSTD_freeDDict(static_cast<ZSTD_DDict *>(ddict));
+#endif
+    }
+
+    /// @brief 加载与服务器相同的 zstd 字典, 没有指定字典时直接成功
+    bool LoadGenerator::loadDictionary() {
+#ifdef KC_WITH_ZSTD
+        if (config.zstdDictionary.empty())
+            return true;
+        std::ifstream file(config.zstdDictionary, std::ios::binary);
+        std::string dictionary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        dictId = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+        ddict = dictId != 0 ? ZSTD_createDDict(dictionary.data(), dictionary.size()) : nullptr;
+        if (ddict == nullptr) {
+            spdlog::error("无法加载 zstd 字典 {}", config.zstdDictionary);
+            dictId = 0;
+            return false;
+        }
+        return true;
+#else
+        spdlog::error("未以 KC_WITH_ZSTD 编译, 不能申请压缩合并帧");
+        return false;
+#endif
+    }
+
+    /// @brief 启动所有工作线程, 压测结束后输出统计
+    void LoadGenerator::run() {
+        spdlog::info("压测开始: {} 个机器人, {} 个线程, 时长 {}s",
+                     config.botCount, config.threadCount, config.duration.count());
+        if (config.zstd && !loadDictionary())
+            config.zstd = false;
+        isRunning = true;
+        std::vector<Stats> stats(config.threadCount);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t tid = 0; tid < config.threadCount; ++tid) {
+            size_t bot_count = config.botCount / config.threadCount
+                               + (tid < config.botCount % config.threadCount ? 1 : 0);
+            threads.emplace_back(&LoadGenerator::worker, this, tid, bot_count, std::ref(stats[tid]));
+        }
+        std::this_thread::sleep_for(config.duration);
+        isRunning = false;
+        for (auto &thread : threads)
+            thread.join();
+        report(stats, std::chrono::steady_clock::now() - start);
+    }
+
+    /// @brief 工作线程: 先依次完成握手, 再用一次 zmq::poll 驱动全部机器人
+    void LoadGenerator::worker(size_t tid, size_t bot_count, Stats &stats) {
+        std::vector<Bot> bots(bot_count);
+        for (auto &bot : bots) {
+            if (!isRunning)
+                break;
+            if (connectBot(bot))
+                ++stats.connected;
+            else
+                ++stats.rejected;
+        }
+        spdlog::info("线程 {} 已连接 {} 个机器人, 被拒绝 {} 个", tid, stats.connected, stats.rejected);
+
+        std::vector<zmq::pollitem_t> poll_items;
+        std::vector<Bot *> polled;
+        for (auto &bot : bots) {
+            if (!bot.connected)
+                continue;
+            poll_items.emplace_back(zmq::pollitem_t{bot.socket, 0, ZMQ_POLLIN, 0});
+            polled.emplace_back(&bot);
+        }
+        while (isRunning && !polled.empty()) {
+            if (zmq::poll(poll_items, std::chrono::milliseconds(100)) == 0)
+                continue;
+            for (size_t i = 0; i < poll_items.size(); ++i) {
+                if (!(poll_items[i].revents & ZMQ_POLLIN))
+                    continue;
+                zmq::message_t msg;
+                while (polled[i]->socket.recv(msg, zmq::recv_flags::dontwait).has_value())
+                    handleFrame(*polled[i], msg, stats);
+            }
+        }
+        for (auto &bot : bots)
+            bot.socket.close();
+    }
+
+    /// @brief 与服务器握手, 流程与交互式测试客户端相同
+    bool LoadGenerator::connectBot(Bot &bot) {
+        zmq::socket_t socket_req(context, ZMQ_REQ);
+        socket_req.set(zmq::sockopt::rcvtimeo, static_cast<int>(config.connectTimeout.count()));
+        socket_req.set(zmq::sockopt::linger, 0);
+        bool is_endpoint = config.address.find("://") != std::string::npos;
+        socket_req.connect(is_endpoint ? config.address : "tcp://" + config.address + ":" + std::to_string(config.port));
+        thread_local std::mt19937 rng(std::random_device{}());
+        ConnectRequest connect_req;
+        connect_req.set_rating(config.ratingBase - config.ratingSpread + rng() % (2 * config.ratingSpread + 1));
+        connect_req.set_wire_format(config.wireFormat);
+        connect_req.set_wire_version(wire::VERSION);
+        connect_req.set_batch_frames(config.batchFrames);
+        connect_req.set_zstd(config.zstd);
+        connect_req.set_zstd_dict_id(dictId);
+        send(socket_req, CommandType::CONNECT_REQ, 0, connect_req.SerializeAsString());
+        zmq::message_t rep_z;
+        if (!socket_req.recv(rep_z, zmq::recv_flags::none).has_value())
+            return false;
+        BasicMessage rep_m;
+        ConnectResponse rep_r;
+        if (!rep_m.ParseFromArray(rep_z.data(), static_cast<int>(rep_z.size()))
+            || rep_m.type() != CommandType::CONNECT_REP || !rep_r.ParseFromString(rep_m.message()))
+            return false;
+
+        bot.id = rep_r.player_id();
+        // 之后这条连接上的消息都使用服务器接受的编码
+        bot.packed = rep_r.wire_format() == wire::PACKED;
+        bot.socket = zmq::socket_t(context, ZMQ_PAIR);
+        bot.socket.set(zmq::sockopt::linger, 0);
+        bot.socket.connect(!rep_r.endpoint().empty() ? rep_r.endpoint()
+                                                     : "tcp://" + config.address + ":" + std::to_string(rep_r.port()));
+        ackConnection(bot);
+        // 开局时的时钟同步与其他消息一样在主循环中应答
+        bot.connected = true;
+        return true;
+    }
+
+    /// @brief 处理收到的一帧, 合并帧先解压再拆开逐条处理
+    void LoadGenerator::handleFrame(Bot &bot, const zmq::message_t &frame, Stats &stats) {
+        ++stats.frames;
+        const auto *data = static_cast<const char *>(frame.data());
+        const wire::Batch *batch = wire::batch(data, frame.size());
+        if (batch == nullptr) {
+            handleMessage(bot, data, frame.size(), stats);
+            return;
+        }
+        std::string_view body(data + sizeof(wire::Batch), frame.size() - sizeof(wire::Batch));
+        if (batch->flags & wire::BATCH_ZSTD) {
+#ifdef KC_WITH_ZSTD
+            thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx *)> dctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+            thread_local std::string raw;
+            raw.resize(batch->rawSize);
+            size_t size = ddict != nullptr
+                          ? ZSTD_decompress_usingDDict(dctx.get(), raw.data(), raw.size(), body.data(), body.size(),
+                                                       static_cast<const ZSTD_DDict *>(ddict))
+                          : ZSTD_decompressDCtx(dctx.get(), raw.data(), raw.size(), body.data(), body.size());
+            if (ZSTD_isError(size) || size != raw.size()) {
+                spdlog::warn("机器人 {} 无法解压合并帧", bot.id);
+                return;
+            }
+            body = raw;
+#else
+            spdlog::warn("机器人 {} 收到了压缩的合并帧, 但未以 KC_WITH_ZSTD 编译", bot.id);
+            return;
+#endif
+        }
+        if (!wire::forEachInBatch(body.data(), body.size(), [&](const char *message, size_t size) {
+            handleMessage(bot, message, size, stats);
+        }))
+            spdlog::warn("机器人 {} 收到的合并帧长度错误", bot.id);
+    }
+
+    /// @brief 处理一条服务器消息, 更新机器人追踪的状态
+    /// @details 紧凑编码时直接在帧内读取字段, protobuf 时先解析外层再解析消息体
+    void LoadGenerator::handleMessage(Bot &bot, const char *data, size_t size, Stats &stats) {
+        ++stats.messages;
+        BasicMessage envelope;
+        CommandType type;
+        std::string_view body;
+        if (!unwrap(bot, data, size, envelope, type, body))
+            return;
+        auto body_size = static_cast<int>(body.size());
+        switch (type) {
+            case CommandType::CONNECT_ACK:
+                ackConnection(bot);
+                break;
+            case CommandType::CLOCK_SYNC:
+                answerClockSync(bot, body);
+                break;
+            case CommandType::NEW_CARD: {
+                if (bot.packed) {
+                    size_t count = 0;
+                    const wire::Card *cards = viewCards(body, count);
+                    for (size_t i = 0; cards != nullptr && i < count; ++i)
+                        bot.hand.emplace_back(cards[i].id, cards[i].type);
+                    break;
+                }
+                NewCard notice;
+                notice.ParseFromArray(body.data(), body_size);
+                for (const auto &card : notice.newcards())
+                    bot.hand.emplace_back(card.id(), card.type());
+                break;
+            }
+            case CommandType::DISCARD_CARD: {
+                if (bot.packed) {
+                    size_t count = 0;
+                    const wire::Card *cards = viewCards(body, count);
+                    for (size_t i = 0; cards != nullptr && i < count; ++i)
+                        removeFromHand(bot, cards[i].id);
+                    break;
+                }
+                DiscardCard notice;
+                notice.ParseFromArray(body.data(), body_size);
+                for (const auto &card : notice.discardedcards())
+                    removeFromHand(bot, card.id());
+                break;
+            }
+            case CommandType::GAME_STATUS: {
+                bot.others.clear();
+                uint32_t current;
+                if (bot.packed) {
+                    const auto *status = wire::view<wire::GameStatus>(body.data(), body.size());
+                    const auto *players = status == nullptr ? nullptr
+                            : wire::viewArray<wire::PlayerState>(body.data(), body.size(), sizeof(wire::GameStatus),
+                                                                 status->totalPlayers);
+                    if (players == nullptr)
+                        break;
+                    for (size_t i = 0; i < status->totalPlayers; ++i)
+                        onPlayerState(bot, players[i].id, players[i].hp, players[i].maxHp);
+                    current = status->currentTurnPlayerId;
+                } else {
+                    GameStatus status;
+                    status.ParseFromArray(body.data(), body_size);
+                    for (const auto &player : status.players())
+                        onPlayerState(bot, player.id(), player.hp(), player.maxhp());
+                    current = status.currentturnplayerid();
+                }
+                if (current != bot.id)
+                    bot.playsThisTurn = 0;
+                break;
+            }
+            case CommandType::NOTICE_CARD: {
+                if (bot.packed) {
+                    const auto *notice = wire::view<wire::NoticeCard>(body.data(), body.size());
+                    if (notice != nullptr)
+                        onNoticeCard(bot, notice->card.id, stats);
+                    break;
+                }
+                NoticeCard notice;
+                notice.ParseFromArray(body.data(), body_size);
+                onNoticeCard(bot, notice.card().id(), stats);
+                break;
+            }
+            case CommandType::ACTION_REJECT: {
+                if (bot.packed) {
+                    const auto *reject = wire::view<wire::ActionReject>(body.data(), body.size());
+                    if (reject != nullptr)
+                        onRejected(bot, reject->card.id, reject->card.type, stats);
+                    break;
+                }
+                ActionReject reject;
+                reject.ParseFromArray(body.data(), body_size);
+                onRejected(bot, reject.card().id(), reject.card().type(), stats);
+                break;
+            }
+            case CommandType::YOUR_TURN: {
+                if (bot.packed) {
+                    const auto *turn = wire::view<wire::YourTurn>(body.data(), body.size());
+                    if (turn != nullptr)
+                        onYourTurn(bot, turn->turnType, stats);
+                    break;
+                }
+                YourTurn turn;
+                turn.ParseFromArray(body.data(), body_size);
+                onYourTurn(bot, turn.turntype(), stats);
+                break;
+            }
+            case CommandType::GAME_OVER:
+            case CommandType::KICK:
+                if (!bot.finished)
+                    ++stats.gamesOver;
+                bot.finished = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    /// @brief 服务端不会广播被拒绝的牌, 放回手牌后直接结束这次出牌机会
+    void LoadGenerator::onRejected(Bot &bot, uint32_t card_id, int card_type, Stats &stats) {
+        bot.hand.emplace_back(card_id, card_type);
+        bot.pendingCardId = -1;
+        ++stats.rejectedPlays;
+        pass(bot, stats);
+    }
+
+    /// @brief 选择一张合法的牌打出, 没有则弃牌/跳过
+    void LoadGenerator::onYourTurn(Bot &bot, int turn_type, Stats &stats) {
+        bot.turnTime = std::chrono::steady_clock::now();
+        if (turn_type < 0 || static_cast<size_t>(turn_type) >= std::size(TurnCardMask))
+            return;
+        bool active = turn_type == TurnType_pb::ACTIVE;
+        bot.activeTurn = active;
+        uint32_t mask = TurnCardMask[turn_type];
+
+        // 选择目标: 第一个存活的其他玩家
+        uint32_t target = bot.id;
+        for (const auto &other : bot.others)
+            if (other.second > 0) {
+                target = other.first;
+                break;
+            }
+
+        auto it = bot.hand.end();
+        if (!active || bot.playsThisTurn < config.maxPlaysPerTurn) {
+            it = std::find_if(bot.hand.begin(), bot.hand.end(), [&](const auto &card) {
+                if (!(mask & (1u << card.second)))
+                    return false;
+                if (active && card.second == PEACH && bot.hp >= bot.maxHp)
+                    return false;
+                return !(active && needsTarget(card.second) && target == bot.id);
+            });
+        }
+
+        if (it != bot.hand.end()) {
+            uint32_t play_target = needsTarget(it->second) ? target : bot.id;
+            bot.pendingCardId = it->first;
+            bot.playTime = std::chrono::steady_clock::now();
+            if (bot.packed) {
+                std::string body;
+                wire::append(body, wire::ActionPlay{
+                        wire::Card{static_cast<uint16_t>(it->first), static_cast<uint8_t>(it->second)},
+                        play_target});
+                sendPacked(bot.socket, CommandType::ACTION_PLAY, bot.id, body);
+            } else {
+                ActionPlay action;
+                action.mutable_card()->set_id(it->first);
+                action.mutable_card()->set_type(static_cast<CardType_pb>(it->second));
+                action.set_targetplayerid(play_target);
+                send(bot.socket, CommandType::ACTION_PLAY, bot.id, action.SerializeAsString());
+            }
+            bot.hand.erase(it);
+            if (active)
+                ++bot.playsThisTurn;
+            ++stats.plays;
+            return;
+        }
+
+        pass(bot, stats);
+    }
+
+    /// @brief 跳过反应, 或在主动回合弃牌并结束回合
+    void LoadGenerator::pass(Bot &bot, Stats &stats) {
+        size_t keep = bot.hand.size();
+        if (bot.activeTurn) {
+            // 主动回合结束时把手牌弃到不超过体力值
+            keep = std::min<size_t>(keep, bot.hp);
+            bot.playsThisTurn = 0;
+        }
+        if (bot.packed) {
+            std::string body;
+            wire::append(body, wire::CardList{static_cast<uint8_t>(bot.hand.size() - keep)});
+            for (size_t i = bot.hand.size(); i > keep; --i)
+                wire::append(body, wire::Card{static_cast<uint16_t>(bot.hand[i - 1].first),
+                                              static_cast<uint8_t>(bot.hand[i - 1].second)});
+            sendPacked(bot.socket, CommandType::ACTION_PASS, bot.id, body);
+        } else {
+            ActionPass pass;
+            for (size_t i = bot.hand.size(); i > keep; --i) {
+                auto *card = pass.add_discardedcards();
+                card->set_id(bot.hand[i - 1].first);
+                card->set_type(static_cast<CardType_pb>(bot.hand[i - 1].second));
+            }
+            send(bot.socket, CommandType::ACTION_PASS, bot.id, pass.SerializeAsString());
+        }
+        bot.hand.resize(keep);
+        ++stats.passes;
+    }
+
+    /// @brief 合并所有线程的统计并输出延迟分位数
+    void LoadGenerator::report(std::vector<Stats> &stats, std::chrono::steady_clock::duration elapsed) {
+        Stats total;
+        for (auto &s : stats) {
+            total.playRtt.insert(total.playRtt.end(), s.playRtt.begin(), s.playRtt.end());
+            total.turnRtt.insert(total.turnRtt.end(), s.turnRtt.begin(), s.turnRtt.end());
+            total.connected += s.connected;
+            total.rejected += s.rejected;
+            total.plays += s.plays;
+            total.rejectedPlays += s.rejectedPlays;
+            total.passes += s.passes;
+            total.gamesOver += s.gamesOver;
+            total.messages += s.messages;
+            total.frames += s.frames;
+        }
+        std::sort(total.playRtt.begin(), total.playRtt.end());
+        std::sort(total.turnRtt.begin(), total.turnRtt.end());
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        spdlog::info("压测结束, 用时 {:.1f}s", seconds);
+        spdlog::info("连接成功: {}, 被拒绝: {}, 结束的对局视角: {}", total.connected, total.rejected, total.gamesOver);
+        spdlog::info("出牌: {}, 被拒绝: {}, 跳过: {}, 收到消息: {} ({:.0f} msg/s), 帧: {} ({:.0f} frame/s)",
+                     total.plays, total.rejectedPlays, total.passes, total.messages,
+                     static_cast<double>(total.messages) / seconds, total.frames,
+                     static_cast<double>(total.frames) / seconds);
+        auto print = [](const char *name, const std::vector<uint32_t> &sorted) {
+            spdlog::info("{} 样本数: {}, p50: {}us, p90: {}us, p99: {}us, p99.9: {}us, max: {}us",
+                         name, sorted.size(), percentile(sorted, 0.5), percentile(sorted, 0.9),
+                         percentile(sorted, 0.99), percentile(sorted, 0.999), sorted.empty() ? 0 : sorted.back());
+        };
+        print("ACTION_PLAY -> NOTICE_CARD", total.playRtt);
+        print("YOUR_TURN -> NOTICE_CARD", total.turnRtt);
+    }
+}
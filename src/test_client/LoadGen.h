@@ -0,0 +1,97 @@
+#ifndef KINGDOMCARD_LOADGEN_H
+#define KINGDOMCARD_LOADGEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+#include "packed_wire.h"
+
+namespace loadgen {
+    struct Config {
+        std::string address = "localhost";      // 也可以是完整的登入端点, 如 ipc:///tmp/kc-server.ipc
+        uint16_t port = 13364;
+        size_t botCount = 100;              // 机器人总数
+        size_t threadCount = 4;             // 工作线程数, 每个线程用 zmq::poll 驱动多个机器人
+        std::chrono::seconds duration {60}; // 压测时长
+        std::chrono::milliseconds connectTimeout {2000};
+        size_t maxPlaysPerTurn = 3;         // 每回合最多主动出牌次数, 之后弃牌结束回合
+        uint32_t ratingBase = 1500;         // 上报的分数在 ratingBase ± ratingSpread 内均匀分布, 用于压测匹配
+        uint32_t ratingSpread = 300;
+        wire::Format wireFormat = wire::PROTOBUF;   // 申请的编码, PACKED 时原地读取消息体, 用于对比两种编码的开销
+        bool batchFrames = false;           // 申请合并帧
+        bool zstd = false;                  // 申请压缩合并帧, 须以 KC_WITH_ZSTD 编译
+        std::string zstdDictionary;         // 与服务器相同的 zstd 字典, 为空时不用字典
+    };
+
+    /// @brief 单个无界面机器人, 记录自己的手牌并自动打出合法的牌
+    struct Bot {
+        zmq::socket_t socket;
+        uint32_t id = 0;
+        bool connected = false;
+        bool finished = false;
+        bool packed = false;                // 服务器接受了紧凑编码
+        uint32_t hp = 4;
+        uint32_t maxHp = 4;
+        size_t playsThisTurn = 0;
+        bool activeTurn = false;                              // 最近一次 YOUR_TURN 是否为主动回合
+        std::vector<std::pair<uint32_t, int>> hand;          // (牌 id, 牌类型)
+        std::vector<std::pair<uint32_t, uint32_t>> others;   // (玩家 id, hp)
+        // 延迟测量: 收到 YOUR_TURN -> 发出 ACTION_PLAY -> 收到对应的 NOTICE_CARD
+        int64_t pendingCardId = -1;
+        std::chrono::steady_clock::time_point turnTime;
+        std::chrono::steady_clock::time_point playTime;
+    };
+
+    /// @brief 每个工作线程的统计, 结束后合并
+    struct Stats {
+        std::vector<uint32_t> playRtt;      // ACTION_PLAY -> NOTICE_CARD, 微秒
+        std::vector<uint32_t> turnRtt;      // YOUR_TURN -> NOTICE_CARD, 微秒
+        size_t connected = 0;
+        size_t rejected = 0;
+        size_t plays = 0;
+        size_t rejectedPlays = 0;           // 被服务端以 ACTION_REJECT 拒绝的出牌
+        size_t passes = 0;
+        size_t gamesOver = 0;
+        size_t messages = 0;
+        size_t frames = 0;                  // 收到的帧数, 合并帧使它少于消息数
+    };
+
+    class LoadGenerator {
+    private:
+        Config config;
+        zmq::context_t context {1};
+        std::atomic<bool> isRunning {false};
+        void *ddict = nullptr;              // ZSTD_DDict, 所有线程共用
+        uint32_t dictId = 0;
+
+        bool loadDictionary();
+
+        void handleFrame(Bot &bot, const zmq::message_t &frame, Stats &stats);
+
+        void worker(size_t tid, size_t bot_count, Stats &stats);
+
+        bool connectBot(Bot &bot);
+
+        void handleMessage(Bot &bot, const char *data, size_t size, Stats &stats);
+
+        void onYourTurn(Bot &bot, int turn_type, Stats &stats);
+
+        static void onRejected(Bot &bot, uint32_t card_id, int card_type, Stats &stats);
+
+        static void pass(Bot &bot, Stats &stats);
+
+        static void report(std::vector<Stats> &stats, std::chrono::steady_clock::duration elapsed);
+
+    public:
+        explicit LoadGenerator(Config config) : config(std::move(config)) {}
+
+        ~LoadGenerator();
+
+        void run();
+    };
+}
+
+#endif //KINGDOMCARD_LOADGEN_H
@@ -1,7 +1,9 @@
 #include <spdlog/spdlog.h>
 #include <zmq.hpp>
+#include <iostream>
 #include "basic_message.pb.h"
 #include "command.pb.h"
+#include "LoadGen.h"
 
 #define GET_ID(card) (card >> 16)
 #define GET_TYPE(card) (card & 0xffff)
@@ -44,11 +46,13 @@ public:
         spdlog::info("tid: {} 收到回复, 类型为{}", tid, CommandType_Name(rep_m.type()));
         ConnectResponse rep_r;
         rep_r.ParseFromString(rep_m.message());
-        spdlog::info("tid: {} 玩家ID为{}, 端口为{}", tid, rep_r.player_id(), rep_r.port());
+        spdlog::info("tid: {} 玩家ID为{}, 端口为{}, 会话令牌为{}", tid, rep_r.player_id(), rep_r.port(),
+                     rep_r.session_token());
 
         id = rep_r.player_id();
         socket_pair = zmq::socket_t(context, ZMQ_PAIR);
-        socket_pair.connect("tcp://localhost:" + std::to_string(rep_r.port()));
+        socket_pair.connect(!rep_r.endpoint().empty() ? rep_r.endpoint()
+                                                      : "tcp://localhost:" + std::to_string(rep_r.port()));
         spdlog::info("tid: {} 连接成功", tid);
         BasicMessage ack_m;
         ack_m.set_type(CommandType::CONNECT_ACK);
@@ -92,6 +96,8 @@ public:
                 ack_m.SerializeToArray(ack_z.data(), ack_z.size());
                 socket_pair.send(ack_z, zmq::send_flags::none);
             }
+            else if (m.type() == CommandType::CLOCK_SYNC)
+                answerClockSync(m);
         }
 
         // 游戏开始后
@@ -102,7 +108,9 @@ public:
             m.ParseFromArray(msg.data(), msg.size());
             spdlog::debug("tid: {} 收到消息, 类型为 {}", tid, CommandType_Name(m.type()));
 //            switch (m.type()) {
-            if(m.type() == GAME_STATUS) {
+            if (m.type() == CLOCK_SYNC) {
+                answerClockSync(m);
+            } else if(m.type() == GAME_STATUS) {
                 spdlog::debug("tid: {} 接收到游戏状态", tid);
                 GameStatus status;
                 status.ParseFromString(m.message());
@@ -126,6 +134,11 @@ public:
                     spdlog::info("tid: {} 牌面 id: {}, type: {}",
                                  tid, notice.card().id(), CardName[notice.card().type()]);
                 }
+            } else if (m.type() == ACTION_REJECT) {
+                ActionReject reject;
+                reject.ParseFromString(m.message());
+                spdlog::warn("tid: {} 出牌被拒绝: 牌面 id: {}, 原因: {}",
+                             tid, reject.card().id(), RejectReason_pb_Name(reject.reason()));
             } else if (m.type() == NOTICE_DYING) {
                 spdlog::debug("tid: {} 接收到濒死信息", tid);
                 NoticeDying notice;
@@ -148,7 +161,12 @@ public:
             } else if (m.type() == YOUR_TURN) {
                 YourTurn notice;
                 notice.ParseFromString(m.message());
-                spdlog::info("tid: {} 是当前回合玩家, 剩余时间: {}ms", tid, notice.remainingtime());
+                // 已同步时钟时按截止时刻计算, 扣除消息在路上的时间
+                auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                spdlog::info("tid: {} 是当前回合玩家, 剩余时间: {}ms", tid,
+                             notice.deadline() != 0 ? static_cast<float>(notice.deadline() - now)
+                                                    : notice.remainingtime());
             } else if (m.type() == NEW_CARD) {
                 NewCard notice;
                 notice.ParseFromString(m.message());
@@ -170,6 +188,20 @@ public:
         }
     }
 
+    /// @brief 填入本地单调时钟后带回服务器的时钟同步探测
+    void answerClockSync(const BasicMessage &m) {
+        ClockSync sync;
+        sync.ParseFromString(m.message());
+        sync.set_client_time(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        BasicMessage sync_m;
+        sync_m.set_type(CommandType::CLOCK_SYNC);
+        sync_m.set_message(sync.SerializeAsString());
+        zmq::message_t sync_z(sync_m.ByteSizeLong());
+        sync_m.SerializeToArray(sync_z.data(), sync_z.size());
+        socket_pair.send(sync_z, zmq::send_flags::none);
+    }
+
     void card_play(size_t num, size_t target) {
         if (num >= cards.size()) {
             spdlog::error("tid: {} 想要出的牌数: {} 大于手牌数: {}", tid, num, cards.size());
@@ -198,7 +230,106 @@ public:
 };
 
 
-int main() {
+/// @brief 压测模式: kc_test_client loadgen <机器人数> <线程数> [时长(s)] [服务器地址或登入端点] [选项...]
+/// @details 选项: packed 申请紧凑编码, batch 申请合并帧, zstd 或 zstd=<字典> 申请压缩合并帧
+int loadgenMain(int argc, char **argv) {
+    spdlog::set_level(spdlog::level::info);
+    loadgen::Config config;
+    if (argc > 2)
+        config.botCount = std::stoul(argv[2]);
+    if (argc > 3)
+        config.threadCount = std::max<size_t>(1, std::stoul(argv[3]));
+    if (argc > 4)
+        config.duration = std::chrono::seconds(std::stoul(argv[4]));
+    if (argc > 5)
+        config.address = argv[5];
+    for (int i = 6; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "packed") {
+            config.wireFormat = wire::PACKED;
+        } else if (option == "batch") {
+            config.batchFrames = true;
+        } else if (option.rfind("zstd", 0) == 0) {
+            config.batchFrames = true;
+            config.zstd = true;
+            if (option.size() > 5 && option[4] == '=')
+                config.zstdDictionary = option.substr(5);
+        } else {
+            spdlog::warn("未知的压测选项: {}", option);
+        }
+    }
+    loadgen::LoadGenerator generator(config);
+    generator.run();
+    return 0;
+}
+
+/// @brief 观战模式: kc_test_client spectate [对局 id] [服务器地址], 不指定对局时观看所有对局
+int spectateMain(int argc, char **argv) {
+    spdlog::set_level(spdlog::level::info);
+    std::string topic = argc > 2 ? "match-" + std::string(argv[2]) + "/" : "";
+    std::string address = argc > 3 ? argv[3] : "localhost";
+    zmq::context_t context(1);
+    zmq::socket_t socket_sub(context, ZMQ_SUB);
+    socket_sub.set(zmq::sockopt::subscribe, topic);
+    socket_sub.connect("tcp://" + address + ":13362");
+    spdlog::info("开始观战: {}", topic.empty() ? "所有对局" : topic);
+    while (true) {
+        zmq::message_t topic_z, msg;
+        if (!socket_sub.recv(topic_z).has_value() || !socket_sub.recv(msg).has_value())
+            continue;
+        BasicMessage m;
+        m.ParseFromArray(msg.data(), msg.size());
+        if (m.type() == GAME_STATUS) {
+            GameStatus status;
+            status.ParseFromString(m.message());
+            spdlog::info("{} 当前回合玩家: {}", topic_z.to_string(), status.currentturnplayerid());
+            for (const auto &player : status.players())
+                spdlog::info("{} 玩家 id: {}, hp: {}/{}, 手牌数: {}{}", topic_z.to_string(), player.id(),
+                             player.hp(), player.maxhp(), player.cardcnt(), player.isalive() ? "" : " (死亡)");
+        } else if (m.type() == NOTICE_CARD) {
+            NoticeCard notice;
+            notice.ParseFromString(m.message());
+            spdlog::info("{} 玩家 {} 向玩家 {} 打出 {}", topic_z.to_string(), notice.playerid(),
+                         notice.targetplayerid(), CardName[notice.card().type()]);
+        } else {
+            spdlog::info("{} {}", topic_z.to_string(), CommandType_Name(m.type()));
+        }
+    }
+}
+
+/// @brief 管理模式: kc_test_client admin [端点] <命令> [参数...], 向本机服务器的管理端口发送一条命令并打印应答
+/// @details 端点默认为 tcp://127.0.0.1:13361; 交接期间可以用 ipc:///tmp/kc-admin-<pid>.ipc 指定进程
+int adminMain(int argc, char **argv) {
+    std::string endpoint = "tcp://127.0.0.1:13361";
+    int first = 2;
+    if (argc > 2 && std::string(argv[2]).find("://") != std::string::npos)
+        endpoint = argv[first++];
+    std::string request;
+    for (int i = first; i < argc; ++i)
+        request += (i > first ? " " : "") + std::string(argv[i]);
+    zmq::context_t context(1);
+    zmq::socket_t socket_req(context, ZMQ_REQ);
+    socket_req.set(zmq::sockopt::rcvtimeo, 30000);
+    socket_req.set(zmq::sockopt::linger, 0);
+    socket_req.connect(endpoint);
+    socket_req.send(zmq::message_t(request.data(), request.size()), zmq::send_flags::none);
+    zmq::message_t reply;
+    if (!socket_req.recv(reply).has_value()) {
+        spdlog::error("管理端口无应答");
+        return 1;
+    }
+    std::string text = reply.to_string();
+    std::cout << text;
+    return text.rfind("OK", 0) == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "admin")
+        return adminMain(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "loadgen")
+        return loadgenMain(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "spectate")
+        return spectateMain(argc, argv);
     spdlog::set_level(spdlog::level::debug);
     zmq::context_t context(1);
     std::vector<std::shared_ptr<Client> > clients;